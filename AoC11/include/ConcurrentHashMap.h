@@ -0,0 +1,154 @@
+// This is a thread safe version of our HashMap, made for running memoized solvers (like the path counting of the Graph) on
+// several cores at the same time. It has the same key and hash template parameters as the HashMap.
+
+// The map is split in shards (lock striping): each shard is one of our HashMaps protected by its own mutex, and the hash of
+// the key decides the shard. Two threads only wait for each other if they touch keys of the same shard.
+
+// The most important method is get_or_compute(key, fn). If two threads ask for the same key at the same time, only the
+// first one runs fn and the other one waits for its result, so a subproblem is never computed twice. The lock is NOT held
+// while fn runs, so fn can call get_or_compute again for other keys (this is what a recursive solver does).
+
+#ifndef CONCURRENT_HASHMAP_H
+#define CONCURRENT_HASHMAP_H
+
+#include "HashMap.h"
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+template<typename K, typename T, typename Hash = DefaultHash<K>,
+         template<typename, typename, typename, typename> class Storage = FlatTable, typename Growth = PowerOfTwoGrowth>
+class ConcurrentHashMap {
+    private:
+        // The value is stored directly in the inner map, with a flag that tells if it is ready or still being computed
+        struct Cell {
+            T value = T();
+            bool ready = false;
+        };
+
+        // alignas(64) puts every shard in its own cache line, so two threads locking different shards do not fight for the same line
+        struct alignas(64) Shard {
+            std::mutex lock;
+            std::condition_variable computed; // Notified every time a value of this shard is ready (or its computation failed)
+            HashMap<K, Cell, Hash, Storage, Growth> map;
+        };
+
+        size_t numShards; // Always a power of two so we can use a mask
+        std::unique_ptr<Shard[]> shards; // Mutexes cannot be moved, so we cannot use a vector that may reallocate
+        Hash hasher;
+
+        // The inner HashMap uses the low bits of the hash, so we choose the shard with the high bits
+        Shard& shardFor(const K& key) const {
+            return shards[(hasher(key) >> 40) & (numShards - 1)];
+        }
+
+    public:
+        ConcurrentHashMap(size_t shardCount = 64) : numShards(PowerOfTwoGrowth::bucketCount(shardCount)), shards(new Shard[numShards]) {}
+
+        // Returns the value of the key, computing it with fn() if it is not in the map. If another thread is already computing
+        // it we wait for that result instead of computing it again. If fn throws, the key is removed and the exception goes
+        // to the caller, the threads that were waiting for that key try to compute it themselves
+        template<typename F>
+        T get_or_compute(const K& key, F&& fn) {
+            Shard& shard = shardFor(key);
+            {
+                std::unique_lock<std::mutex> guard(shard.lock);
+                while (true) {
+                    auto [cell, inserted] = shard.map.try_emplace(key);
+                    if (inserted) {
+                        break; // We own the computation of this key
+                    }
+                    if (cell->ready) {
+                        return cell->value; // The value is already there
+                    }
+                    // Another thread is computing it, we sleep until something of this shard is computed and look again
+                    // (we look for the key again as the slot may have moved if the inner map was resized)
+                    shard.computed.wait(guard);
+                }
+            }
+            T value;
+            try {
+                value = fn(); // The lock is released, fn can use the map recursively
+            } catch (...) {
+                {
+                    std::lock_guard<std::mutex> guard(shard.lock);
+                    shard.map.remove(key);
+                }
+                shard.computed.notify_all();
+                throw;
+            }
+            {
+                std::lock_guard<std::mutex> guard(shard.lock);
+                Cell* cell = shard.map.find(key);
+                cell->value = value;
+                cell->ready = true;
+            }
+            shard.computed.notify_all();
+            return value;
+        }
+
+        // Inserts or overwrites a value
+        void set(const K& key, const T& value) {
+            Shard& shard = shardFor(key);
+            {
+                std::lock_guard<std::mutex> guard(shard.lock);
+                Cell& cell = shard.map[key];
+                cell.value = value;
+                cell.ready = true;
+            }
+            shard.computed.notify_all(); // Somebody could be waiting for a computation of this key
+        }
+
+        // True if the key has a value (a value that is still being computed does not count)
+        bool contains(const K& key) const {
+            Shard& shard = shardFor(key);
+            std::lock_guard<std::mutex> guard(shard.lock);
+            const Cell* cell = shard.map.find(key);
+            return cell != nullptr && cell->ready;
+        }
+
+        // Returns the value of the key, waiting if it is being computed. Throws if the key does not exist
+        T get(const K& key) const {
+            Shard& shard = shardFor(key);
+            std::unique_lock<std::mutex> guard(shard.lock);
+            while (true) {
+                const Cell* cell = shard.map.find(key);
+                if (cell == nullptr) {
+                    throw std::runtime_error("Key not found");
+                }
+                if (cell->ready) {
+                    return cell->value;
+                }
+                shard.computed.wait(guard);
+            }
+        }
+
+        // Number of keys (including the ones being computed). It locks the shards one by one, so it is only exact when no
+        // other thread is inserting
+        size_t size() const {
+            size_t total = 0;
+            for (size_t i = 0; i < numShards; i++) {
+                std::lock_guard<std::mutex> guard(shards[i].lock);
+                total += shards[i].map.size();
+            }
+            return total;
+        }
+
+        // Makes room for n elements, split evenly between the shards
+        void reserve(size_t n) {
+            for (size_t i = 0; i < numShards; i++) {
+                std::lock_guard<std::mutex> guard(shards[i].lock);
+                shards[i].map.reserve(n / numShards + 1);
+            }
+        }
+
+        // Removes everything. It must not be called while another thread is computing a value
+        void clear() {
+            for (size_t i = 0; i < numShards; i++) {
+                std::lock_guard<std::mutex> guard(shards[i].lock);
+                shards[i].map.clear();
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,186 @@
+// NodeInterner: gives every node of a Graph a dense 32-bit id (0, 1, 2... in the order they are added) and translates between
+// both. The maps of the Graph are keyed on the ids, so a node is only hashed when it crosses the public API (addEdge,
+// countPaths...) and every step of a traversal works with 4-byte integers.
+// Before, with Graph<std::string> (AoC11) every adjacency list, memo table, in-degree and the set of all the nodes kept its own
+// std::string copy of the names (32 bytes each, plus a heap block for the long ones), and hasNode was an O(log n) search of
+// std::strings in a std::set.
+// The std::string version is a string pool: the characters of every name are copied once into an Arena (they never move, the
+// arena only grows) and the interner keeps a std::string_view to them, both in the id -> name array and as the key of the
+// name -> id map. Any other NodeType is kept in a vector, the nodes are usually small (int, pair...).
+// An id is never given to another node: a node removed from the graph keeps its id, and gets it back if it is added again.
+
+#ifndef NODE_INTERNER_H
+#define NODE_INTERNER_H
+
+#include "HashMap.h"
+#include "Allocators.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <memory_resource>
+
+// Generic version, the nodes are stored in a vector (id -> node) and a HashMap (node -> id)
+template<typename NodeType, template<typename, typename, typename, typename> class Storage = ChainedTable>
+class NodeInterner {
+    public:
+        using NodeId = uint32_t;
+        using NameRef = const NodeType&; // What name() returns
+
+    private:
+        std::pmr::vector<NodeType> nodes; // nodes[id] is the node with that id
+        HashMap<NodeType, NodeId, DefaultHash<NodeType>, Storage> ids; // And the way back
+
+    public:
+        explicit NodeInterner(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : nodes(resource), ids(resource) {}
+
+        // Id of the node, a new one if it was never seen
+        NodeId intern(const NodeType& node) {
+            auto [id, inserted] = ids.try_emplace(node, static_cast<NodeId>(nodes.size()));
+            if (inserted) {
+                if (nodes.size() == std::numeric_limits<NodeId>::max()) {
+                    ids.remove(node);
+                    throw std::runtime_error("Too many nodes for the 32-bit ids of the Graph.");
+                }
+                nodes.push_back(node);
+            }
+            return *id;
+        }
+
+        // Id of the node or nullptr if it was never seen (Q other than NodeType only with a transparent hash)
+        template<typename Q>
+        const NodeId* find(const Q& node) const {
+            return ids.find(node);
+        }
+
+        NameRef name(NodeId id) const {
+            return nodes[id];
+        }
+
+        // Number of ids given so far
+        size_t size() const {
+            return nodes.size();
+        }
+
+        void reserve(size_t count) {
+            nodes.reserve(count);
+            ids.reserve(count);
+        }
+
+        void clear() {
+            nodes.clear();
+            ids.clear();
+        }
+
+        // About the bytes of the interner: the id -> node array and one pair per bucket of the map (the extra bytes of the
+        // engine, like the control bytes or the list nodes, are not counted)
+        size_t memoryBytes() const {
+            return nodes.capacity() * sizeof(NodeType) + ids.bucketCount() * sizeof(HashEntry<NodeType, NodeId>);
+        }
+
+#ifdef HASHMAP_STATS
+        std::string statsJson() const {
+            return ids.statsJson();
+        }
+#endif
+};
+
+// String pool: the characters of the names are in an Arena and the rest of the interner only keeps string_views to them
+template<template<typename, typename, typename, typename> class Storage>
+class NodeInterner<std::string, Storage> {
+    public:
+        using NodeId = uint32_t;
+        using NameRef = std::string_view;
+
+    private:
+        static constexpr size_t kPoolChunk = 16 * 1024; // First chunk of the pool, the AoC11 names (605 of 3 characters) fit in it
+
+        Arena pool; // Characters of all the names, one after the other (without the '\0')
+        std::pmr::vector<std::string_view> names; // names[id] is the name with that id
+        HashMap<std::string_view, NodeId, DefaultHash<std::string_view>, Storage> ids; // The views point to the pool, not to the caller
+
+    public:
+        // The pool takes its chunks from resource, so with an Arena graph the names also end up in that arena
+        explicit NodeInterner(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : pool(kPoolChunk, resource), names(resource), ids(resource) {}
+
+        // A copy can not share the views (they point to the pool of the other one), the names are interned again in our pool
+        // with the same ids. Same resource as the original
+        NodeInterner(const NodeInterner& other) : NodeInterner(other.names.get_allocator().resource()) {
+            *this = other;
+        }
+
+        NodeInterner& operator=(const NodeInterner& other) {
+            if (this != &other) {
+                clear();
+                reserve(other.size());
+                for (std::string_view name : other.names) intern(name);
+            }
+            return *this;
+        }
+
+        // Id of the name, a new one if it was never seen. Only a new name is copied (into the pool)
+        NodeId intern(std::string_view name) {
+            if (const NodeId* id = ids.find(name)) {
+                return *id;
+            }
+            if (names.size() == std::numeric_limits<NodeId>::max()) {
+                throw std::runtime_error("Too many nodes for the 32-bit ids of the Graph.");
+            }
+            char* characters = static_cast<char*>(pool.allocate(name.size() == 0 ? 1 : name.size(), 1));
+            std::memcpy(characters, name.data(), name.size());
+            std::string_view stored(characters, name.size());
+            NodeId id = static_cast<NodeId>(names.size());
+            names.push_back(stored);
+            ids.try_emplace(stored, id);
+            return id;
+        }
+
+        // Id of the name or nullptr if it was never seen. It takes a std::string, a std::string_view or a const char*
+        template<typename Q>
+        const NodeId* find(const Q& name) const {
+            return ids.find(std::string_view(name));
+        }
+
+        NameRef name(NodeId id) const {
+            return names[id];
+        }
+
+        size_t size() const {
+            return names.size();
+        }
+
+        void reserve(size_t count) {
+            names.reserve(count);
+            ids.reserve(count);
+        }
+
+        // Forgets every name, the newest chunk of the pool is kept for the next ones
+        void clear() {
+            ids.clear();
+            names.clear();
+            pool.reset();
+        }
+
+        // Bytes of the characters of the names (the views and the map are not included)
+        size_t poolBytes() const {
+            return pool.bytesUsed();
+        }
+
+        // Same as the generic memoryBytes, plus the chunks of the pool
+        size_t memoryBytes() const {
+            return names.capacity() * sizeof(std::string_view) + pool.bytesReserved()
+                + ids.bucketCount() * sizeof(HashEntry<std::string_view, NodeId>);
+        }
+
+#ifdef HASHMAP_STATS
+        std::string statsJson() const {
+            return ids.statsJson();
+        }
+#endif
+};
+
+#endif
@@ -0,0 +1,132 @@
+// A fixed group of threads for the level by level algorithms of the Graph (countPathsLevels). Creating the threads for every
+// step would cost more than the step itself, so the pool creates them once and every call to parallelFor wakes them up.
+
+// The calling thread is thread 0 and also works, so a pool of size() threads starts size() - 1 of them. parallelFor(count, fn)
+// splits [0, count) in size() contiguous chunks, runs fn(begin, end, thread) for each chunk on its own thread and returns
+// when all of them finished (thread is 0 .. size() - 1, to give every thread its own output buffer). Everything that the
+// threads wrote is visible to the caller after it returns, and to the threads in the next call (the mutex orders it), so
+// the steps of an algorithm can be separated by the calls without any other lock.
+// Only one thread can call parallelFor at a time.
+// UPDATE: fn can throw. Before, an exception of the calling thread left parallelFor while the workers were still running
+// the callable that lived in its stack frame (and one of a worker ended the program). Now every thread catches what its
+// chunk throws, parallelFor waits for all of them as usual and then rethrows the first exception.
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <exception>
+
+class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex lock;
+        std::condition_variable wake; // The workers wait here for the next job
+        std::condition_variable finished; // And the caller waits here for the workers
+        size_t generation = 0; // Number of jobs so far, a worker runs the job when it sees a new generation
+        size_t pending = 0; // Workers that did not finish the current job
+        bool stopping = false;
+        // The current job, without std::function (it would allocate for every call): the function that runs the callable
+        // of the caller and a pointer to it
+        void (*job)(void*, size_t) = nullptr;
+        void* context = nullptr;
+        std::exception_ptr failure; // First exception thrown by a chunk of the current job (written with the lock held)
+
+        // Runs the chunk of a thread, an exception is kept for the caller instead of leaving the thread
+        void runCaught(size_t index) {
+            try {
+                job(context, index);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!failure) failure = std::current_exception();
+            }
+        }
+
+        void workerLoop(size_t index) {
+            size_t seen = 0;
+            std::unique_lock<std::mutex> guard(lock);
+            while (true) {
+                wake.wait(guard, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                guard.unlock();
+                runCaught(index); // job only changes after every worker finished, so it is safe to read it without the lock
+                guard.lock();
+                if (--pending == 0) {
+                    finished.notify_one();
+                }
+            }
+        }
+
+        // Runs fn(thread) on every thread of the pool at the same time (thread 0 is the caller)
+        template<typename F>
+        void runOnAll(F& fn) {
+            if (workers.empty()) {
+                fn(0);
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                job = [](void* callable, size_t index) { (*static_cast<F*>(callable))(index); };
+                context = &fn;
+                pending = workers.size();
+                failure = nullptr;
+                generation++;
+            }
+            wake.notify_all();
+            runCaught(0); // Even if our chunk throws we must wait, the workers are still using fn
+            std::unique_lock<std::mutex> guard(lock);
+            finished.wait(guard, [&] { return pending == 0; });
+            if (failure) {
+                std::exception_ptr error = failure;
+                failure = nullptr;
+                std::rethrow_exception(error);
+            }
+        }
+
+    public:
+        explicit ThreadPool(size_t threads = std::thread::hardware_concurrency()) {
+            threads = std::max<size_t>(threads, 1); // hardware_concurrency() can return 0
+            workers.reserve(threads - 1);
+            for (size_t i = 1; i < threads; i++) {
+                workers.emplace_back(&ThreadPool::workerLoop, this, i);
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Number of threads, counting the caller
+        size_t size() const {
+            return workers.size() + 1;
+        }
+
+        // fn(begin, end, thread) on size() contiguous chunks of [0, count), one per thread. Returns when all of them are done
+        template<typename F>
+        void parallelFor(size_t count, F&& fn) {
+            size_t threads = size();
+            auto chunk = [&](size_t index) {
+                size_t begin = count * index / threads;
+                size_t end = count * (index + 1) / threads;
+                if (begin < end) fn(begin, end, index);
+            };
+            runOnAll(chunk);
+        }
+};
+
+#endif
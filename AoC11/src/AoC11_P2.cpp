@@ -1,7 +1,7 @@
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include "../include/Graph.h"
 
 using namespace std;
@@ -14,22 +14,30 @@ int main() {
     }
 
     // Build the graph
-    Graph<string> graph;
+    // The graph is built once and lives until the end, so all its maps take their memory from an arena (see Allocators.h)
+    Arena arena(64 * 1024);
+    Graph<string> graph(true, false, false, &arena);
     
     string line;
     while (getline(file, line)) {
-        size_t dotsPos = line.find(':'); 
-        string node = line.substr(0, dotsPos);
-        string dependencies = line.substr(dotsPos + 2); // Skip ": "
-        
-        istringstream iss(dependencies);
-        string dep;
-        while (iss >> dep) {
-            graph.addEdge(node, dep);  // edge from node to dep
+        // We cut the line with string_view and pass the pieces to the graph as they are (UPDATE: no string is built, the
+        // graph copies a name into its pool only the first time it sees it)
+        string_view view(line);
+        size_t dotsPos = view.find(':');
+        string_view node = view.substr(0, dotsPos);
+        string_view dependencies = view.substr(dotsPos + 2); // Skip ": "
+
+        while (!dependencies.empty()) {
+            size_t spacePos = dependencies.find(' ');
+            string_view dep = dependencies.substr(0, spacePos);
+            if (!dep.empty()) {
+                graph.addEdge(node, dep);  // edge from node to dep
+            }
+            dependencies = spacePos == string_view::npos ? string_view() : dependencies.substr(spacePos + 1);
         }
     }
     file.close();
-    printf("Graph constructed with %d nodes.\n", graph.getTotalNodes());
+    printf("Graph constructed with %zu nodes.\n", graph.getTotalNodes());
     // Here we count paths from "svr" to "out" that visit both "dac" and "fft"
     long long result = graph.countPathsThrough2("svr", "out", "dac", "fft");
 
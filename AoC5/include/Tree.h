@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <queue>
 #include <variant>
+#include <type_traits>
+#include "Allocators.h"
 
 using namespace std;
 
@@ -90,11 +92,30 @@ class Tree {
     private:
         int nelem;
         Node<T> *root;
+        // UPDATE: The nodes come from a memory resource (the heap by default, see Allocators.h) instead of new and delete
+        std::pmr::memory_resource* resource;
+        bool bulkRelease; // True if the nodes live in an Arena and need no destructor, then deleteAll does not walk the tree
+
+        template<typename... Args>
+        Node<T>* newNode(Args&&... args) {
+            void* memory = resource->allocate(sizeof(Node<T>), alignof(Node<T>));
+            try {
+                return new (memory) Node<T>(std::forward<Args>(args)...);
+            } catch (...) {
+                resource->deallocate(memory, sizeof(Node<T>), alignof(Node<T>));
+                throw;
+            }
+        }
+
+        void deleteNode(Node<T>* n) {
+            n->~Node<T>();
+            resource->deallocate(n, sizeof(Node<T>), alignof(Node<T>));
+        }
 
         //Unified insert for single elements
         Node<T>* insert(Node<T>* n, T e){
             if (n == nullptr) {
-                return new Node<T>(e);
+                return newNode(e);
             } else if(n->getStart() == e){
                 throw runtime_error("Duplicate element");
             } else if(n->getStart() < e){
@@ -110,7 +131,7 @@ class Tree {
         Node<T>* insert(Node<T>* n, const Interval<T>& interval) {
             // Base case: If the tree is empty, return a new node
             if (n == nullptr) {
-                return new Node<T>(interval);
+                return newNode(interval);
             }
             // Otherwise, recur down the tree
             if (interval.start < n->getStart()) {
@@ -239,7 +260,9 @@ class Tree {
                     n->data = maxVal;
                     n->left = remove_max(n->left);
                 } else {
-                    n = (n->left != nullptr) ? n->left : n->right;
+                    Node<T>* child = (n->left != nullptr) ? n->left : n->right;
+                    deleteNode(n); // Before, the removed node was never freed
+                    n = child;
                 }
             }
             updateMaxRange(n);
@@ -249,7 +272,9 @@ class Tree {
         //Remove maximum element in the tree
         Node<T>* remove_max(Node<T>* n){
             if(n->right == nullptr) {
-                return n->left;
+                Node<T>* left = n->left;
+                deleteNode(n);
+                return left;
             } else {
                 n->right = remove_max(n->right);
                 updateMaxRange(n);
@@ -260,7 +285,9 @@ class Tree {
         //Remove minimum element in the tree
         Node<T>* remove_min(Node<T>* n){
             if(n->left == nullptr) {
-                return n->right;
+                Node<T>* right = n->right;
+                deleteNode(n);
+                return right;
             } else {
                 n->left = remove_min(n->left);
                 updateMaxRange(n);
@@ -290,11 +317,13 @@ class Tree {
             }
           }
         //Delete all nodes in the tree
+        //UPDATE: With an Arena it is O(1), the nodes stay in the arena until it is reset or destroyed
          void deleteAll(Node<T>* n){
+            if(bulkRelease) return;
             if(n != nullptr){
                 deleteAll(n->left);
                 deleteAll(n->right);
-                delete n;
+                deleteNode(n);
             }
         }
         
@@ -313,7 +342,7 @@ class Tree {
             if (start > end) return nullptr;
 
             int mid = start + (end - start) / 2;
-            Node<T>* node = new Node<T>(elements[mid]);
+            Node<T>* node = newNode(elements[mid]);
 
             node->left = buildBalanced(elements, start, mid - 1);
             node->right = buildBalanced(elements, mid + 1, end);
@@ -327,7 +356,7 @@ class Tree {
             if (start > end) return nullptr;
 
             int mid = start + (end - start) / 2;
-            Node<T>* node = new Node<T>(intervals[mid]);
+            Node<T>* node = newNode(intervals[mid]);
 
             node->left = buildBalancedFromIntervals(intervals, start, mid - 1);
             node->right = buildBalancedFromIntervals(intervals, mid + 1, end);
@@ -429,10 +458,17 @@ class Tree {
         
     public:
         //Constructor
-        Tree() {
-            this->nelem = 0;
-            this->root = nullptr;
-        }
+        Tree() : Tree(std::pmr::get_default_resource()) {}
+
+        //Constructor with a memory resource for the nodes, for example a NodePool(sizeof(Node<T>)) if we remove a lot
+        explicit Tree(std::pmr::memory_resource* resource) : nelem(0), root(nullptr), resource(resource), bulkRelease(false) {}
+
+        //Constructor with an Arena, the whole tree is freed at once with the arena (it must live longer than the tree)
+        explicit Tree(Arena& arena) : nelem(0), root(nullptr), resource(&arena), bulkRelease(std::is_trivially_destructible<Node<T>>::value) {}
+
+        //A copy would delete the same nodes twice
+        Tree(const Tree&) = delete;
+        Tree& operator=(const Tree&) = delete;
         
         //Get number of elements
         int size() const {
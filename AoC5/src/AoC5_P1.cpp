@@ -13,8 +13,9 @@ using namespace std;
 
 // Example usage for AoC5
 int main() {
-    // Tree object
-    Tree<long long> tree;
+    // Tree object, the tree is built once and only searched, so its nodes live in an arena and are freed all at once
+    Arena arena;
+    Tree<long long> tree(arena);
 
     // Vector for storing intervals
     vector<Interval<long long>> intervals;
@@ -9,11 +9,11 @@
 #include <vector>
 #include <string>
 // #include <set> Changed approach
-#include "../../include/HashMap.h"
+#include "../../../INCLUDE/DenseBitSet.h" // UPDATE: The columns are small integers, so we use a bitset instead of the HashMap
 
 using namespace std;
 
-// IMPORTANT, changed the first approach of set to the custom HashMap
+// IMPORTANT, changed the first approach of set to the custom HashMap, and then to a DenseBitSet
 
 int main() {
     ifstream inputFile("data/AoC7.txt"); // We get the input from this file
@@ -44,9 +44,13 @@ int main() {
 
     currentRowVec.push_back(startCol); // We start with the laser at the starting column
 
+    // To avoid duplicates in the next row. The columns go from -1 to cols (a laser can leave the grid), so we store col + 1.
+    // We create it once and clear it in every row, clear() only resets the words that were used
+    DenseBitSet nextSeen(cols + 2);
+
     for (int row = 0; row < rows && !currentRowVec.empty(); ++row) {
         vector<int> nextRowVec; // Here we store the next row lasers
-        HashMap<int, bool> nextSeen; // To avoid duplicates in the next row we now use our HashMap
+        nextSeen.clear();
 
         for (int col : currentRowVec) { // We process each laser in the current row
             if (col < 0 || col >= cols) continue;
@@ -55,19 +59,17 @@ int main() {
             if (cell == '^') {
                 if (row + 1 < rows) {
                     int a = col - 1, b = col + 1;
-                    if (!nextSeen.contains(a)) {  // We check if we have already seen 'a' using contains()
-                        nextSeen.set(a, true); // We mark it as seen
+                    if (nextSeen.insert(a + 1)) { // insert() marks 'a' as seen and tells us if it was new
                         nextRowVec.push_back(a); // We push the new laser to the next row
                     }
-                    if (!nextSeen.contains(b)) { // Same with b
-                        nextSeen.set(b, true); 
-                        nextRowVec.push_back(b); 
+                    if (nextSeen.insert(b + 1)) { // Same with b
+                        nextRowVec.push_back(b);
                     }
                 }
                 totalSplittings++; // we hit a splitter, then we count it
             } else if (cell == '.' || cell == 'S') {
                 if (row + 1 < rows) {
-                    if (!nextSeen.contains(col)) { nextSeen.set(col, true); nextRowVec.push_back(col); }
+                    if (nextSeen.insert(col + 1)) nextRowVec.push_back(col);
                 }
             }
         }
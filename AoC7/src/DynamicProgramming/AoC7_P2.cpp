@@ -1,4 +1,4 @@
-#include "../../include/HashMap.h"
+#include "../../../INCLUDE/HashMap.h" // We now use the reusable HashMap so we can choose its storage engine
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -8,7 +8,8 @@ using namespace std;
 
 vector<string> grid;
 int rows, cols;
-HashMap<int, long long> memo; // Here we use our own custom HashMap
+DenseMap<int, long long> memo; // UPDATE: The keys are the cells of the grid (0 to rows * cols - 1), so the key is directly the
+                               // slot of the value (DirectTable engine) instead of being hashed into a FlatTable
 
 // Now we convert (row, col) to a unique int key for utilizing it in our HashMap
 int getKey(int row, int col) {
@@ -24,7 +25,7 @@ long long countPaths(int row, int col) {
     
     // Now we check if already computed
     int key = getKey(row, col);
-    if (memo.contains(key)) return memo.get(key);
+    if (const long long* cached = memo.find(key)) return *cached; // find() does the lookup only once
     
     char cell = grid[row][col];
     long long result = 0;
@@ -38,7 +39,7 @@ long long countPaths(int row, int col) {
     }
     // In case of other characters: laser stops, result stays at 0
     
-    memo.set(key, result); // Now we store in the memoization map
+    memo.try_emplace(key, result); // Now we store in the memoization map (we know the key is new)
     return result;
 }
 int main() {
@@ -52,6 +53,7 @@ int main() {
 
     rows = grid.size();
     cols = grid[0].size();
+    memo.reserve(rows * cols); // Every key is in [0, rows * cols), so the memo never resizes
 
     // Find the starting position of the laser (S)
     int startCol = -1;
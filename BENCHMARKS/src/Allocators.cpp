@@ -0,0 +1,115 @@
+// Memory resources: the heap (new and delete, what we used before) against the Arena and the NodePool of Allocators.h, on
+// the two places where we allocate one node per element: the memo HashMap of a query and the Tree.
+// Every test builds the container, uses it and destroys it, as a query (or a day) does. We count the calls to operator new
+// too, the resources only call it for their chunks.
+
+#include "../../INCLUDE/HashMap.h"
+#include "../../INCLUDE/Tree.h"
+#include "../../INCLUDE/Allocators.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <memory>
+
+using namespace std;
+
+static long long heapCalls = 0;
+
+void* operator new(size_t n) {
+    heapCalls++;
+    void* p = malloc(n);
+    if (p == nullptr) throw bad_alloc();
+    return p;
+}
+// The default memory resource of the std::pmr containers calls the aligned version
+void* operator new(size_t n, align_val_t alignment) {
+    heapCalls++;
+    size_t a = static_cast<size_t>(alignment);
+    void* p = aligned_alloc(a, (n + a - 1) / a * a);
+    if (p == nullptr) throw bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { free(p); }
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Builds a memo of n keys, reads it once and destroys it, 'runs' times. makeResource gives the resource of each run
+// (nullptr for the heap)
+template<template<typename, typename, typename, typename> class Storage, typename MakeResource>
+void runMemo(const string& name, const vector<int>& keys, int runs, MakeResource makeResource) {
+    long long checksum = 0;
+    long long callsBefore = heapCalls;
+    double ms = timeMs([&] {
+        for (int r = 0; r < runs; r++) {
+            auto resource = makeResource();
+            HashMap<int, long long, DefaultHash<int>, Storage> memo(resource.get() ? resource.get() : pmr::get_default_resource());
+            for (int key : keys) memo.try_emplace(key, key);
+            for (int key : keys) checksum += *memo.find(key);
+        }
+    });
+    cout << "  " << name << ": " << ms / runs << " ms per memo, " << (heapCalls - callsBefore) / runs << " heap calls (checksum " << checksum << ")" << endl;
+}
+
+// Inserts the keys one by one, searches all of them and removes half of them (AoC5 style tree)
+template<typename MakeTree>
+void runTree(const string& name, const vector<long long>& keys, int runs, MakeTree makeTree) {
+    long long found = 0;
+    long long callsBefore = heapCalls;
+    double ms = timeMs([&] {
+        for (int r = 0; r < runs; r++) {
+            makeTree([&](Tree<long long>& tree) {
+                for (long long key : keys) tree.insert(key);
+                for (long long key : keys) found += tree.search(key) == key;
+                for (size_t i = 0; i < keys.size(); i += 2) tree.remove(keys[i]);
+            });
+        }
+    });
+    cout << "  " << name << ": " << ms / runs << " ms per tree, " << (heapCalls - callsBefore) / runs << " heap calls (" << found / runs << " found)" << endl;
+}
+
+int main() {
+    mt19937 rng(5);
+    for (int n : {1000, 100000}) {
+        int runs = n == 1000 ? 2000 : 20;
+        vector<int> keys(n);
+        for (int& key : keys) key = rng();
+        cout << "Memo of " << n << " keys (" << runs << " runs)" << endl;
+        auto heap = [] { return unique_ptr<pmr::memory_resource>(); };
+        auto arena = [] { return unique_ptr<pmr::memory_resource>(new Arena()); };
+        auto pool = [] { return unique_ptr<pmr::memory_resource>(new NodePool(64)); };
+        runMemo<ChainedTable>("ChainedTable, heap         ", keys, runs, heap);
+        runMemo<ChainedTable>("ChainedTable, Arena        ", keys, runs, arena);
+        runMemo<ChainedTable>("ChainedTable, NodePool(64) ", keys, runs, pool);
+        runMemo<IncrementalTable>("IncrementalTable, heap     ", keys, runs, heap);
+        runMemo<IncrementalTable>("IncrementalTable, Arena    ", keys, runs, arena);
+        runMemo<FlatTable>("FlatTable, heap            ", keys, runs, heap);
+        runMemo<FlatTable>("FlatTable, Arena           ", keys, runs, arena);
+    }
+
+    vector<long long> treeKeys(200000);
+    for (size_t i = 0; i < treeKeys.size(); i++) treeKeys[i] = static_cast<long long>(i) * 7919 % 1000003; // Distinct keys in random order
+    cout << "Tree<long long> with 2 * 10^5 keys (10 runs)" << endl;
+    runTree("heap (new/delete)          ", treeKeys, 10, [](auto&& use) { Tree<long long> tree; use(tree); });
+    runTree("NodePool                   ", treeKeys, 10, [](auto&& use) {
+        NodePool pool(sizeof(Node<long long>));
+        Tree<long long> tree(&pool);
+        use(tree);
+    });
+    runTree("Arena (O(1) destruction)   ", treeKeys, 10, [](auto&& use) {
+        Arena arena;
+        Tree<long long> tree(arena);
+        use(tree);
+    });
+    return 0;
+}
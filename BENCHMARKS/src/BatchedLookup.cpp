@@ -0,0 +1,81 @@
+// Batched lookups: a loop of find() against findMany / containsMany, which hash a block of keys and prefetch their buckets
+// before comparing anything. We use one table that fits in the L2 cache and one much bigger than the L3 cache of our
+// machine (105 MB), where every lookup is a cache miss.
+
+#include "../../INCLUDE/HashMap.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Best time of 'runs' executions, this machine is noisy and the best run is the most stable number
+template<typename F>
+double bestMs(int runs, F&& f) {
+    double best = 1e18;
+    for (int r = 0; r < runs; r++) best = min(best, timeMs(f));
+    return best;
+}
+
+template<template<typename, typename, typename, typename> class Storage>
+void run(const string& name, int n, int queries) {
+    mt19937 rng(12);
+    HashMap<int, long long, DefaultHash<int>, Storage> map;
+    map.reserve(n);
+    vector<int> keys(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = static_cast<int>(rng() & 0x7fffffff);
+        map.set(keys[i], i);
+    }
+    // Half of the queries exist and half do not, in random order
+    vector<int> query(queries);
+    for (int i = 0; i < queries; i++) {
+        query[i] = i % 2 == 0 ? keys[rng() % n] : static_cast<int>(rng() | 0x80000000u);
+    }
+
+    int foundLoop = 0, foundBatch = 0;
+    long long sumLoop = 0, sumBatch = 0;
+    vector<long long> values(queries / 2);
+    vector<int> present(queries / 2);
+    for (int i = 0; i < queries / 2; i++) present[i] = query[2 * i];
+    double containsLoopMs = bestMs(5, [&] {
+        foundLoop = 0;
+        for (int key : query) foundLoop += map.contains(key);
+    });
+    double containsManyMs = bestMs(5, [&] {
+        foundBatch = map.containsMany(query.data(), queries);
+    });
+    double getLoopMs = bestMs(5, [&] {
+        sumLoop = 0;
+        for (int key : present) sumLoop += map.get(key);
+    });
+    double getManyMs = bestMs(5, [&] {
+        sumBatch = 0;
+        map.getMany(present.data(), static_cast<int>(present.size()), values.data());
+        for (long long value : values) sumBatch += value;
+    });
+    cout << "  " << name << ": contains loop " << containsLoopMs << " ms, containsMany " << containsManyMs << " ms"
+         << (foundLoop == foundBatch ? "" : " (DIFFERENT result)") << " | get loop " << getLoopMs << " ms, getMany "
+         << getManyMs << " ms" << (sumLoop == sumBatch ? "" : " (DIFFERENT result)") << endl;
+}
+
+int main() {
+    cout << "Small table, 2 * 10^4 keys (fits in L2), 10^7 queries (best of 5)" << endl;
+    run<ChainedTable>("ChainedTable    ", 20000, 10000000);
+    run<IncrementalTable>("IncrementalTable", 20000, 10000000);
+    run<FlatTable>("FlatTable       ", 20000, 10000000);
+    cout << "Big table, 10^7 keys (several hundred MB, bigger than L3), 10^7 queries (best of 5)" << endl;
+    run<ChainedTable>("ChainedTable    ", 10000000, 10000000);
+    run<IncrementalTable>("IncrementalTable", 10000000, 10000000);
+    run<FlatTable>("FlatTable       ", 10000000, 10000000);
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Bloom filter front (BloomFront in HashMap.h): first the false positive rate of the BlockedBloomFilter at different bits per
+// key, then contains() on tables where a part of the lookups miss, with and without the filter, for a table that does not
+// fit in the cache (2 * 10^6 keys, also with the batched containsMany) and one that does (10^4 keys). Then the AVX2 check
+// against the scalar loop, and the AoC11 graph with every map of the Graph behind a filter.
+
+#include "../../INCLUDE/Graph.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template<typename F>
+double bestMs(int runs, F&& f) {
+    double best = 1e18;
+    for (int r = 0; r < runs; r++) best = min(best, timeMs(f));
+    return best;
+}
+
+// Fills a filter of 2^14 blocks with the keys that bitsPerKey gives and checks 10^7 keys that were never added
+void falsePositives(int bitsPerKey) {
+    BlockedBloomFilter filter;
+    const long long bits = (1LL << 14) * 512;
+    long long keys = bits / bitsPerKey;
+    filter.reset(keys, bitsPerKey);
+    mt19937_64 rng(20);
+    DefaultHash<long long> hasher;
+    for (long long i = 0; i < keys; i++) filter.add(hasher(static_cast<long long>(rng())));
+    const int queries = 10000000;
+    long long positives = 0;
+    for (int i = 0; i < queries; i++) positives += filter.mayContain(hasher(static_cast<long long>(rng())));
+    cout << "  " << bitsPerKey << " bits per key: " << 100.0 * positives / queries << "% false positives" << endl;
+}
+
+// 'queries' lookups of which a fraction 'missRate' are keys that are not in the table
+vector<int> makeQueries(const vector<int>& keys, int queries, double missRate, mt19937& rng) {
+    vector<int> result(queries);
+    uniform_real_distribution<double> coin(0, 1);
+    for (int& q : result) {
+        q = coin(rng) < missRate ? -1 - static_cast<int>(rng() & 0x3fffffff) : keys[rng() % keys.size()]; // Negative keys are never inserted
+    }
+    return result;
+}
+
+// contains() one by one, or containsMany() on the whole vector when batched (the prefetches of the batch also go to the filter)
+template<template<typename, typename, typename, typename> class Storage>
+double timeContains(const vector<int>& keys, const vector<int>& queries, long long& found, bool batched = false) {
+    HashMap<int, long long, DefaultHash<int>, Storage> map;
+    for (int key : keys) map.set(key, key);
+    return bestMs(3, [&] {
+        found = 0;
+        if (batched) {
+            found = map.containsMany(queries.data(), static_cast<int>(queries.size()));
+        } else {
+            for (int q : queries) found += map.contains(q);
+        }
+    });
+}
+
+void runMisses(int n, int queryCount, bool batched) {
+    mt19937 rng(21);
+    vector<int> keys(n);
+    for (int& key : keys) key = static_cast<int>(rng() & 0x7fffffff);
+    cout << n << " keys, " << queryCount << (batched ? " keys in containsMany()" : " contains()") << " (ns per lookup, best of 3)" << endl;
+    for (double missRate : {1.0, 0.9, 0.5, 0.0}) {
+        vector<int> queries = makeQueries(keys, queryCount, missRate, rng);
+        long long f1, f2, f3, f4;
+        double chained = timeContains<ChainedTable>(keys, queries, f1, batched);
+        double bloomChained = timeContains<BloomChainedTable>(keys, queries, f2, batched);
+        double flat = timeContains<FlatTable>(keys, queries, f3, batched);
+        double bloomFlat = timeContains<BloomFlatTable>(keys, queries, f4, batched);
+        cout << "  " << missRate * 100 << "% misses: ChainedTable " << chained * 1e6 / queryCount << ", BloomChainedTable "
+             << bloomChained * 1e6 / queryCount << ", FlatTable " << flat * 1e6 / queryCount << ", BloomFlatTable "
+             << bloomFlat * 1e6 / queryCount << (f1 == f2 && f2 == f3 && f3 == f4 ? "" : " DIFFERENT result") << endl;
+    }
+}
+
+// Only misses, with the check forced to the scalar loop and to AVX2
+void runDispatch() {
+    mt19937 rng(22);
+    vector<int> keys(2000000);
+    for (int& key : keys) key = static_cast<int>(rng() & 0x7fffffff);
+    vector<int> queries = makeQueries(keys, 10000000, 1.0, rng);
+    GroupProbe original = activeGroupProbe();
+    cout << "Filter check, 100% misses on the BloomFlatTable of 2 * 10^6 keys (ns per lookup)" << endl;
+    for (GroupProbe mode : {GroupProbe::Scalar, GroupProbe::AVX2}) {
+        if (mode == GroupProbe::AVX2 && original != GroupProbe::AVX2) continue; // The CPU does not have it
+        activeGroupProbe() = mode; // Also changes the group probing of the FlatTable, but with 100% rejected misses it is never reached
+        long long found = 0;
+        double ms = timeContains<BloomFlatTable>(keys, queries, found);
+        cout << "  " << (mode == GroupProbe::AVX2 ? "AVX2  " : "Scalar") << ": " << ms * 1e6 / queries.size() << endl;
+    }
+    activeGroupProbe() = original;
+}
+
+template<template<typename, typename, typename, typename> class Storage>
+double timeAoC11(const vector<pair<string, string>>& edges, long long& total) {
+    Graph<string, int, int, Storage> graph;
+    for (const auto& [from, to] : edges) graph.addEdge(from, to);
+    vector<string> nodes = graph.getAllNodes();
+    return bestMs(5, [&] {
+        total = 0;
+        for (const string& node : nodes) total += graph.countPaths(node, "out");
+    });
+}
+
+int main() {
+    cout << "False positive rate of a full filter (2^14 blocks, 10^7 queries)" << endl;
+    for (int bitsPerKey : {8, 12, 16, 24, 32}) falsePositives(bitsPerKey);
+
+    runMisses(2000000, 10000000, false);
+    runMisses(2000000, 10000000, true);
+    runMisses(10000, 10000000, false);
+    runDispatch();
+
+    ifstream file("../AoC11/text/AoC11.txt");
+    vector<pair<string, string>> edges;
+    string line;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string from, to;
+        ss >> from;
+        from.pop_back();
+        while (ss >> to) edges.emplace_back(from, to);
+    }
+    long long t1, t2;
+    double chained = timeAoC11<ChainedTable>(edges, t1);
+    double bloom = timeAoC11<BloomChainedTable>(edges, t2);
+    cout << "AoC11, countPaths(node, \"out\") for every node (best of 5): ChainedTable " << chained << " ms, BloomChainedTable "
+         << bloom << " ms" << (t1 == t2 ? "" : " DIFFERENT result") << endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Contention benchmark of the ConcurrentHashMap with 1, 4, 16 and 64 threads.
+// The total work is the same for every thread count, so in a perfect world the time would go down as we add threads
+// (as long as the machine has that many cores).
+
+#include "../../INCLUDE/ConcurrentHashMap.h"
+#include "../../INCLUDE/Graph.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Every thread calls get_or_compute on random keys of [0, keyRange), the total number of calls is always 'totalOps'
+double runGetOrCompute(int threads, int keyRange, int totalOps) {
+    ConcurrentHashMap<int, long long> map;
+    return timeMs([&] {
+        vector<thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                mt19937 rng(t);
+                for (int i = 0; i < totalOps / threads; i++) {
+                    int key = rng() % keyRange;
+                    map.get_or_compute(key, [key] { return static_cast<long long>(key) * key; });
+                }
+            });
+        }
+        for (thread& w : workers) w.join();
+    });
+}
+
+int main() {
+    const int totalOps = 4000000;
+    const int threadCounts[] = {1, 4, 16, 64};
+    cout << "Hardware threads: " << thread::hardware_concurrency() << endl;
+
+    cout << "get_or_compute, 4 * 10^6 calls" << endl;
+    cout << "  threads   low contention (10^6 keys)   high contention (64 keys)" << endl;
+    for (int threads : threadCounts) {
+        double low = runGetOrCompute(threads, 1000000, totalOps);
+        double high = runGetOrCompute(threads, 64, totalOps);
+        cout << "  " << threads << "\t    " << low << " ms\t\t\t " << high << " ms" << endl;
+    }
+
+    // Parallel path counting on a wide synthetic DAG: 2000 layers of 50 nodes, every node goes to 3 nodes of the next layer
+    Graph<int> wide;
+    for (int layer = 0; layer < 2000; layer++) {
+        for (int i = 0; i < 50; i++) {
+            for (int k = 0; k < 3; k++) {
+                wide.addEdge(layer * 50 + i, (layer + 1) * 50 + (i + k * 7) % 50);
+            }
+        }
+    }
+    for (int i = 0; i < 50; i++) wide.addEdge(-1, i); // Common source
+    for (int i = 0; i < 50; i++) wide.addEdge(2000 * 50 + i, -2); // Common sink
+
+    // AoC11 input
+    Graph<string> aoc;
+    ifstream file("../AoC11/text/AoC11.txt");
+    string line;
+    while (getline(file, line)) {
+        size_t dotsPos = line.find(':');
+        string node = line.substr(0, dotsPos);
+        istringstream iss(line.substr(dotsPos + 2));
+        string dep;
+        while (iss >> dep) aoc.addEdge(node, dep);
+    }
+
+    cout << "countPathsParallel" << endl;
+    cout << "  threads   wide DAG (100k nodes)   AoC11 svr -> out" << endl;
+    for (int threads : threadCounts) {
+        long long a = 0, b = 0;
+        double wideMs = timeMs([&] { a = wide.countPathsParallel(-1, -2, threads); });
+        double aocMs = timeMs([&] { b = aoc.countPathsParallel("svr", "out", threads); });
+        cout << "  " << threads << "\t    " << wideMs << " ms\t\t    " << aocMs << " ms   (" << a << ", " << b << ")" << endl;
+    }
+    return 0;
+}
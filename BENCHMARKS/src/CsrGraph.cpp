@@ -0,0 +1,146 @@
+// Graph against its frozen CsrGraph (Graph::freeze(), CsrGraph.h): the time of freeze() and of the traversals on both.
+// First the AoC11 graph (string nodes): countPaths from every node to "out" and the countPathsThrough2 of part 2. Then a
+// random DAG of 10^6 int nodes with 1 to 4 edges each (2.5 * 10^6 edges) where nothing fits in the cache: countPaths,
+// bfsShortestPath and countPathsThrough2 from node 0, and dijkstra from node 0 on the same graph with random weights.
+// Every result of the CsrGraph is checked against the Graph.
+
+#include "../../INCLUDE/CsrGraph.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template<typename F>
+double bestMs(int runs, F&& f) {
+    double best = 1e18;
+    for (int r = 0; r < runs; r++) best = min(best, timeMs(f));
+    return best;
+}
+
+// Prints one row: the Graph time, the CsrGraph time and the speedup, and whether both gave the same result
+void row(const string& name, double graphMs, double csrMs, bool same) {
+    cout << "  " << name << ": Graph " << graphMs << " ms, CsrGraph " << csrMs << " ms (" << graphMs / csrMs << "x)"
+         << (same ? "" : " DIFFERENT result") << endl;
+}
+
+void runAoC11() {
+    ifstream file("../AoC11/text/AoC11.txt");
+    Graph<string> graph;
+    string line;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string from, to;
+        ss >> from;
+        from.pop_back(); // The ':' after the name
+        while (ss >> to) graph.addEdge(from, to);
+    }
+    CsrGraph<string> frozen;
+    double freezeMs = bestMs(20, [&] { frozen = graph.freeze(); });
+    cout << "AoC11 graph (" << frozen.size() << " nodes, " << frozen.edgeCount() << " edges, best of 20): freeze " << freezeMs
+         << " ms, " << frozen.memoryBytes() / 1024 << " KB" << endl;
+
+    vector<string> nodes = graph.getAllNodes();
+    Graph<string>::PathsMemo memo;
+    long long graphTotal = 0, csrTotal = 0;
+    double graphMs = bestMs(20, [&] {
+        graphTotal = 0;
+        for (const string& node : nodes) graphTotal += graph.countPaths(node, "out", memo);
+    });
+    double csrMs = bestMs(20, [&] {
+        csrTotal = 0;
+        for (const string& node : nodes) csrTotal += frozen.countPaths(node, "out");
+    });
+    row("countPaths(node, \"out\") for every node", graphMs, csrMs, graphTotal == csrTotal);
+
+    long long graphPaths = 0, csrPaths = 0;
+    graphMs = bestMs(20, [&] { graphPaths = graph.countPathsThrough2("svr", "out", "dac", "fft"); });
+    csrMs = bestMs(20, [&] { csrPaths = frozen.countPathsThrough2("svr", "out", "dac", "fft"); });
+    row("countPathsThrough2(\"svr\", \"out\", \"dac\", \"fft\")", graphMs, csrMs, graphPaths == csrPaths);
+}
+
+void runRandom() {
+    const int n = 1000000;
+    mt19937 rng(22);
+    Graph<int> graph;
+    Graph<int> weightedGraph(true, true, false);
+    size_t edges = 0;
+    for (int from = 0; from < n - 1; from++) {
+        int degree = 1 + rng() % 4;
+        for (int d = 0; d < degree; d++) {
+            int to = from + 1 + rng() % min(1000, n - 1 - from); // Always to a bigger node, so there are no cycles
+            graph.addEdge(from, to);
+            weightedGraph.addEdge(from, to, static_cast<int>(1 + rng() % 100));
+            edges++;
+        }
+    }
+    CsrGraph<int> frozen;
+    CsrGraph<int> frozenWeighted;
+    double freezeMs = timeMs([&] { frozen = graph.freeze(); });
+    frozenWeighted = weightedGraph.freeze();
+    cout << "Random DAG (" << n << " nodes, " << edges << " edges, best of 3): freeze " << freezeMs << " ms, "
+         << frozen.memoryBytes() / (1024 * 1024) << " MB" << endl;
+
+    Graph<int>::PathsMemo memo;
+    long long graphPaths = 0, csrPaths = 0;
+    double graphMs = bestMs(3, [&] { graphPaths = graph.countPaths(0, n - 1, memo); });
+    double csrMs = bestMs(3, [&] { csrPaths = frozen.countPaths(0, n - 1); });
+    row("countPaths(0, n - 1)", graphMs, csrMs, graphPaths == csrPaths);
+
+    graphMs = bestMs(3, [&] { graphPaths = graph.countPathsThrough2(0, n - 1, n / 3, 2 * n / 3); });
+    csrMs = bestMs(3, [&] { csrPaths = frozen.countPathsThrough2(0, n - 1, n / 3, 2 * n / 3); });
+    row("countPathsThrough2(0, n - 1, n / 3, 2n / 3)", graphMs, csrMs, graphPaths == csrPaths);
+
+    vector<int> graphPath, csrPath;
+    graphMs = bestMs(3, [&] { graphPath = graph.bfsShortestPath(0, n - 1); });
+    csrMs = bestMs(3, [&] { csrPath = frozen.bfsShortestPath(0, n - 1); });
+    row("bfsShortestPath(0, n - 1)", graphMs, csrMs, graphPath.size() == csrPath.size());
+
+    vector<pair<int, int>> graphDistances, csrDistances;
+    graphMs = bestMs(3, [&] { graphDistances = weightedGraph.dijkstra(0); });
+    csrMs = bestMs(3, [&] { csrDistances = frozenWeighted.dijkstra(0); });
+    // The order of two nodes with the same distance can change, so we compare the distances of every node
+    vector<int> graphByNode(n, -1), csrByNode(n, -1);
+    for (const auto& [node, distance] : graphDistances) graphByNode[node] = distance;
+    for (const auto& [node, distance] : csrDistances) csrByNode[node] = distance;
+    row("dijkstra(0)", graphMs, csrMs, graphByNode == csrByNode);
+
+    vector<int> order;
+    csrMs = bestMs(3, [&] { order = frozen.topologicalSort(); });
+    cout << "  topologicalSort: CsrGraph " << csrMs << " ms (" << order.size() << " nodes)" << endl;
+}
+
+// Cases that failed before: "Aa" and "BB" had the same hash and freeze() threw, and the recursive countPaths of the CsrGraph
+// overflowed the stack on a chain of 10^6 nodes
+void runChecks() {
+    Graph<string> small;
+    small.addEdge("Aa", "BB");
+    small.addEdge("BB", "out");
+    CsrGraph<string> frozenSmall = small.freeze();
+    bool ok = frozenSmall.countPaths("Aa", "out") == 1 && frozenSmall.countPathsThrough2("Aa", "out", "Aa", "BB") == 1;
+
+    const int n = 1000000;
+    Graph<int> chain;
+    for (int i = 0; i < n - 1; i++) chain.addEdge(i, i + 1);
+    CsrGraph<int> frozenChain = chain.freeze();
+    ok = ok && frozenChain.countPaths(0, n - 1) == 1 && frozenChain.countPathsThrough2(0, n - 1, n / 3, 2 * n / 3) == 1;
+    cout << "Colliding names and a chain of " << n << " nodes: " << (ok ? "ok" : "WRONG result") << endl;
+}
+
+int main() {
+    runChecks();
+    runAoC11();
+    runRandom();
+    return 0;
+}
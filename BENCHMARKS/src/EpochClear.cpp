@@ -0,0 +1,111 @@
+// Reusing one memo table for many queries: a new map for every query against clear() on the same map, with the engines whose
+// clear() touches every bucket (ChainedTable, FlatTable) and the EpochTable, whose clear() only moves to the next epoch.
+// First a table sized for 10^6 keys where every round only inserts a few keys (the worst case for a clear that walks the
+// buckets), then the queries of the AoC11 graph with the scratch of countPaths built per query or kept by the caller (PathsMemo).
+
+#include "../../INCLUDE/Graph.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template<typename F>
+double bestMs(int runs, F&& f) {
+    double best = 1e18;
+    for (int r = 0; r < runs; r++) best = min(best, timeMs(f));
+    return best;
+}
+
+// 'rounds' rounds of 'perRound' inserts and lookups on one map reserved for 10^6 keys, cleared after every round
+template<template<typename, typename, typename, typename> class Storage>
+void runReuse(const string& name, const vector<int>& keys, int rounds, int perRound) {
+    HashMap<int, long long, DefaultHash<int>, Storage> memo;
+    memo.reserve(1000000);
+    long long found = 0;
+    double ms = bestMs(3, [&] {
+        found = 0;
+        for (int r = 0; r < rounds; r++) {
+            memo.clear();
+            for (int i = 0; i < perRound; i++) memo.try_emplace(keys[(r * perRound + i) % keys.size()], i);
+            for (int i = 0; i < perRound; i++) found += memo.contains(keys[(r * perRound + i) % keys.size()]);
+        }
+    });
+    cout << "  " << name << ": " << ms * 1e3 / rounds << " us per round (" << found << " found)" << endl;
+}
+
+// Same rounds but building a new map in every round (without the reserve, it grows with the keys of the round)
+template<template<typename, typename, typename, typename> class Storage>
+void runFresh(const string& name, const vector<int>& keys, int rounds, int perRound) {
+    long long found = 0;
+    double ms = bestMs(3, [&] {
+        found = 0;
+        for (int r = 0; r < rounds; r++) {
+            HashMap<int, long long, DefaultHash<int>, Storage> memo;
+            for (int i = 0; i < perRound; i++) memo.try_emplace(keys[(r * perRound + i) % keys.size()], i);
+            for (int i = 0; i < perRound; i++) found += memo.contains(keys[(r * perRound + i) % keys.size()]);
+        }
+    });
+    cout << "  " << name << ": " << ms * 1e3 / rounds << " us per round (" << found << " found)" << endl;
+}
+
+int main() {
+    mt19937 rng(17);
+    vector<int> keys(1 << 20);
+    for (int& key : keys) key = static_cast<int>(rng() & 0x7fffffff);
+    for (int perRound : {16, 1000}) {
+        int rounds = perRound == 16 ? 500 : 200;
+        cout << "Table reserved for 10^6 keys, " << rounds << " rounds of " << perRound << " inserts + " << perRound
+             << " lookups, clear() after every round (best of 3)" << endl;
+        runReuse<ChainedTable>("ChainedTable clear", keys, rounds, perRound);
+        runReuse<FlatTable>("FlatTable    clear", keys, rounds, perRound);
+        runReuse<EpochTable>("EpochTable   clear", keys, rounds, perRound);
+        runFresh<FlatTable>("FlatTable    new  ", keys, rounds, perRound);
+        runFresh<EpochTable>("EpochTable   new  ", keys, rounds, perRound);
+    }
+
+    // AoC11: paths from every node to "out", 20 times, so 12100 queries
+    ifstream file("../AoC11/text/AoC11.txt");
+    Graph<string> graph;
+    string line;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string from, to;
+        ss >> from;
+        from.pop_back();
+        while (ss >> to) graph.addEdge(from, to);
+    }
+    vector<string> nodes = graph.getAllNodes();
+    const int repetitions = 20;
+    long long totalFresh = 0, totalReused = 0;
+    double freshMs = bestMs(3, [&] {
+        totalFresh = 0;
+        for (int r = 0; r < repetitions; r++) {
+            for (const string& node : nodes) totalFresh += graph.countPaths(node, "out");
+        }
+    });
+    Graph<string>::PathsMemo memo;
+    double reusedMs = bestMs(3, [&] {
+        totalReused = 0;
+        for (int r = 0; r < repetitions; r++) {
+            for (const string& node : nodes) totalReused += graph.countPaths(node, "out", memo);
+        }
+    });
+    size_t queries = repetitions * nodes.size();
+    cout << "AoC11 graph, countPaths(node, \"out\") for every node, " << queries << " queries (best of 3)" << endl;
+    cout << "  scratch per query     : " << freshMs * 1e3 / queries << " us per query" << endl;
+    cout << "  reused PathsMemo      : " << reusedMs * 1e3 / queries << " us per query"
+         << (totalFresh == totalReused ? "" : " DIFFERENT result") << endl;
+    return 0;
+}
@@ -0,0 +1,159 @@
+// FrozenHashMap (minimal perfect hash, read only) against the mutable HashMap it is built from: build time, bits per key of
+// the index, memory and lookup throughput. First with the adjacency lists of the AoC11 graph (string keys, tiny table),
+// then with random int keys in tables bigger than the L2 and the L3 caches.
+
+#include "../../INCLUDE/FrozenHashMap.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template<typename F>
+double bestMs(int runs, F&& f) {
+    double best = 1e18;
+    for (int r = 0; r < runs; r++) best = min(best, timeMs(f));
+    return best;
+}
+
+// Millions of lookups per second
+double mops(size_t lookups, double ms) {
+    return lookups / ms / 1000.0;
+}
+
+template<template<typename, typename, typename, typename> class Storage>
+void runAoC11(const string& name, const vector<pair<string, vector<string>>>& lines, const vector<string>& queries) {
+    HashMap<string, vector<string>, DefaultHash<string>, Storage> adjacency;
+    for (const auto& line : lines) adjacency.set(line.first, line.second);
+    FrozenHashMap<string, vector<string>> frozen;
+    double buildMs = timeMs([&] { frozen = adjacency.freeze(); });
+
+    const int repetitions = 2000;
+    long long sumMap = 0, sumFrozen = 0;
+    double mapMs = bestMs(5, [&] {
+        sumMap = 0;
+        for (int r = 0; r < repetitions; r++) {
+            for (const string& query : queries) {
+                if (const vector<string>* neighbors = adjacency.find(query)) sumMap += neighbors->size();
+            }
+        }
+    });
+    double frozenMs = bestMs(5, [&] {
+        sumFrozen = 0;
+        for (int r = 0; r < repetitions; r++) {
+            for (const string& query : queries) {
+                if (const vector<string>* neighbors = frozen.find(query)) sumFrozen += neighbors->size();
+            }
+        }
+    });
+    size_t lookups = static_cast<size_t>(repetitions) * queries.size();
+    cout << "  " << name << ": " << mops(lookups, mapMs) << " M lookups/s, frozen " << mops(lookups, frozenMs)
+         << " M lookups/s (freeze " << buildMs << " ms, " << frozen.bitsPerKey() << " bits per key)"
+         << (sumMap == sumFrozen ? "" : " DIFFERENT result") << endl;
+}
+
+template<template<typename, typename, typename, typename> class Storage>
+void runRandom(const string& name, const vector<int>& keys, const vector<int>& queries) {
+    HashMap<int, long long, DefaultHash<int>, Storage> map;
+    double insertMs = timeMs([&] {
+        for (int key : keys) map.set(key, key);
+    });
+    FrozenHashMap<int, long long> frozen;
+    double buildMs = timeMs([&] { frozen = map.freeze(); });
+
+    long long sumMap = 0, sumFrozen = 0;
+    double mapMs = bestMs(3, [&] {
+        sumMap = 0;
+        for (int query : queries) {
+            if (const long long* value = map.find(query)) sumMap += *value;
+        }
+    });
+    double frozenMs = bestMs(3, [&] {
+        sumFrozen = 0;
+        for (int query : queries) {
+            if (const long long* value = frozen.find(query)) sumFrozen += *value;
+        }
+    });
+    cout << "  " << name << ": inserts " << insertMs << " ms, freeze " << buildMs << " ms (" << buildMs * 1e6 / keys.size()
+         << " ns per key), " << frozen.bitsPerKey() << " bits per key, " << frozen.memoryBytes() / 1048576.0 << " MB frozen" << endl;
+    cout << "    lookups: " << mops(queries.size(), mapMs) << " M/s mutable, " << mops(queries.size(), frozenMs) << " M/s frozen"
+         << (sumMap == sumFrozen ? "" : " DIFFERENT result") << endl;
+}
+
+// A hash that only looks at the length, so all the keys of the same length have the same full hash
+struct LengthHash {
+    unsigned long long operator()(const string& key) const {
+        return key.size();
+    }
+    size_t operator()(const string& key, size_t hashSize) const {
+        return key.size() % hashSize;
+    }
+};
+
+// Keys with the same full hash used to make freeze() throw. "Aa" and "BB" had the same hash with the old string hash, and
+// with LengthHash every key of the same length collides, so they go to the overflow list of the FrozenHashMap
+template<typename Hash>
+bool checkCollisions(const vector<string>& keys) {
+    HashMap<string, int, Hash> map;
+    for (size_t i = 0; i < keys.size(); i++) map.set(keys[i], static_cast<int>(i));
+    FrozenHashMap<string, int, Hash> frozen = map.freeze();
+    bool ok = frozen.size() == keys.size() && !frozen.contains("Ab") && !frozen.contains("Zzz");
+    for (size_t i = 0; i < keys.size(); i++) {
+        const int* value = frozen.find(keys[i]);
+        ok = ok && value != nullptr && *value == static_cast<int>(i);
+    }
+    return ok;
+}
+
+int main() {
+    vector<string> colliding = {"Aa", "BB", "C#", "out", "svr", "dac", "fft", "x"};
+    bool collisionsOk = checkCollisions<DefaultHash<string>>(colliding) && checkCollisions<LengthHash>(colliding);
+    cout << "Keys with the same hash: " << (collisionsOk ? "ok" : "WRONG result") << endl;
+
+    // AoC11: every line is "name: neighbor neighbor ..."
+    ifstream file("../AoC11/text/AoC11.txt");
+    vector<pair<string, vector<string>>> lines;
+    vector<string> queries; // Every name that appears in the input, so the leaves (no line of their own) are misses
+    string line;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string from, to;
+        ss >> from;
+        from.pop_back();
+        vector<string> neighbors;
+        while (ss >> to) {
+            neighbors.push_back(to);
+            queries.push_back(to);
+        }
+        queries.push_back(from);
+        lines.emplace_back(from, neighbors);
+    }
+    cout << "AoC11 adjacency lists (" << lines.size() << " keys, " << queries.size() << " queries x 2000, best of 5)" << endl;
+    runAoC11<ChainedTable>("ChainedTable", lines, queries);
+    runAoC11<FlatTable>("FlatTable   ", lines, queries);
+
+    mt19937 rng(14);
+    for (int n : {1000000, 5000000}) {
+        vector<int> keys(n);
+        for (int& key : keys) key = static_cast<int>(rng() & 0x7fffffff);
+        vector<int> queries(10000000); // Half hits and half misses, in random order
+        for (size_t i = 0; i < queries.size(); i++) {
+            queries[i] = i % 2 == 0 ? keys[rng() % n] : static_cast<int>(rng() | 0x80000000u);
+        }
+        cout << "Random int keys, " << n << " keys, 10^7 lookups (best of 3)" << endl;
+        runRandom<ChainedTable>("ChainedTable", keys, queries);
+        runRandom<FlatTable>("FlatTable   ", keys, queries);
+    }
+    return 0;
+}
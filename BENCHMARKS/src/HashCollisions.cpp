@@ -0,0 +1,136 @@
+// Collision statistics of our hash functions on the real key sets of AoC7 and AoC11.
+// "Before" is the hash we had originally (key value or polynomial and a modulo by a prime size),
+// "Mask only" is the old hash with a power of two size (what would happen without the mixer),
+// "After" is the mixed hash (mix64) with a power of two size and a mask, our current default.
+
+#include "../../INCLUDE/HashMap.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <tuple>
+
+using namespace std;
+
+// The original hash functions (before the mixer) so we can compare both versions
+unsigned long long oldStringHash(const string& key) {
+    unsigned long long hash = 0;
+    for (char c : key) hash = hash * 31 + static_cast<unsigned long long>(c);
+    return hash;
+}
+
+unsigned long long oldPairHash(int a, int b) {
+    return static_cast<unsigned long long>(a) * 31 + static_cast<unsigned long long>(b);
+}
+
+unsigned long long oldTupleHash(const string& s, bool v1, bool v2) {
+    return (oldStringHash(s) * 31 + v1) * 31 + v2;
+}
+
+// Statistics of a table of 'size' buckets for the given bucket indexes
+struct Stats {
+    int size;
+    int usedBuckets;
+    int maxChain;
+    double avgChainProbes; // Average keys compared in a successful lookup with separate chaining
+    double avgLinearProbes; // Average slots visited in a successful lookup with linear probing
+};
+
+Stats computeStats(const vector<int>& buckets, int size) {
+    vector<int> chain(size, 0);
+    for (int b : buckets) chain[b]++;
+    Stats st = {size, 0, 0, 0, 0};
+    for (int c : chain) {
+        if (c > 0) st.usedBuckets++;
+        st.maxChain = max(st.maxChain, c);
+        st.avgChainProbes += c * (c + 1) / 2.0;
+    }
+    st.avgChainProbes /= buckets.size();
+
+    // We simulate linear probing insertions in the same order
+    vector<char> used(size, 0);
+    long long probes = 0;
+    for (int b : buckets) {
+        int i = b;
+        probes++;
+        while (used[i]) { i = (i + 1) % size; probes++; }
+        used[i] = 1;
+    }
+    st.avgLinearProbes = static_cast<double>(probes) / buckets.size();
+    return st;
+}
+
+// Size that each policy would have after inserting n keys with a 0.75 load factor, starting from the smallest size
+int tightSize(int n, bool powerOfTwo) {
+    int requested = static_cast<int>(n / 0.75) + 1;
+    return powerOfTwo ? PowerOfTwoGrowth::bucketCount(requested) : PrimeGrowth::bucketCount(requested);
+}
+
+void report(const string& name, const vector<unsigned long long>& oldHashes, const vector<unsigned long long>& newHashes) {
+    int n = oldHashes.size();
+    int primeSize = tightSize(n, false), twoSize = tightSize(n, true);
+    vector<int> before, maskOnly, after;
+    for (int i = 0; i < n; i++) {
+        before.push_back(PrimeGrowth::index(oldHashes[i], primeSize));
+        maskOnly.push_back(PowerOfTwoGrowth::index(oldHashes[i], twoSize));
+        after.push_back(PowerOfTwoGrowth::index(newHashes[i], twoSize));
+    }
+    cout << name << " (" << n << " keys)" << endl;
+    cout << "  version    buckets  used   max chain  chain probes  linear probes" << endl;
+    auto row = [](const string& label, const Stats& st) {
+        cout << "  " << left << setw(10) << label << right << setw(8) << st.size << setw(7) << st.usedBuckets
+             << setw(11) << st.maxChain << setw(14) << fixed << setprecision(2) << st.avgChainProbes
+             << setw(15) << st.avgLinearProbes << endl;
+    };
+    row("Before", computeStats(before, primeSize));
+    row("Mask only", computeStats(maskOnly, twoSize));
+    row("After", computeStats(after, twoSize));
+}
+
+int main() {
+    // AoC7: every cell of the grid as row * cols + col (AoC7_P2.cpp) and as (row, col) pairs
+    ifstream gridFile("../AoC7/data/AoC7.txt");
+    vector<string> grid;
+    string line;
+    while (getline(gridFile, line)) grid.push_back(line);
+    int rows = grid.size(), cols = grid[0].size();
+    vector<unsigned long long> oldInt, newInt, oldPair, newPair;
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            int key = r * cols + c;
+            oldInt.push_back(key);
+            newInt.push_back(DefaultHash<int>()(key));
+            oldPair.push_back(oldPairHash(r, c));
+            newPair.push_back(PairHash<int, int>()({r, c}));
+        }
+    }
+
+    // AoC11: the node names and the (node, visited1, visited2) states of countPathsThrough2
+    ifstream edgeFile("../AoC11/text/AoC11.txt");
+    set<string> names;
+    while (getline(edgeFile, line)) {
+        size_t dotsPos = line.find(':');
+        names.insert(line.substr(0, dotsPos));
+        istringstream iss(line.substr(dotsPos + 2));
+        string dep;
+        while (iss >> dep) names.insert(dep);
+    }
+    vector<unsigned long long> oldName, newName, oldState, newState;
+    for (const string& name : names) {
+        oldName.push_back(oldStringHash(name));
+        newName.push_back(DefaultHash<string>()(name));
+        for (int flags = 0; flags < 4; flags++) {
+            oldState.push_back(oldTupleHash(name, flags & 1, flags & 2));
+            newState.push_back(TupleHash3<string, bool, bool>()(make_tuple(name, bool(flags & 1), bool(flags & 2))));
+        }
+    }
+
+    report("AoC7 int keys row * cols + col", oldInt, newInt);
+    report("AoC7 pair keys (row, col)", oldPair, newPair);
+    report("AoC11 node names", oldName, newName);
+    report("AoC11 tuple states (name, visited1, visited2)", oldState, newState);
+    return 0;
+}
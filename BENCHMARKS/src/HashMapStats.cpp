@@ -0,0 +1,92 @@
+// Statistics of the HashMap (HASHMAP_STATS). The Makefile builds this file twice: programs/HashMapStats with -DHASHMAP_STATS,
+// which prints the JSON of the AoC11 graph and the chains of a table at different load factors, and programs/HashMapStatsOff
+// without it, which only runs the timed part. Comparing the times of both tells what the counters cost.
+
+#include "../../INCLUDE/Graph.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// 10^6 insertions and 2 * 10^6 lookups (half of them misses), best of 5 runs
+template<template<typename, typename, typename, typename> class Storage>
+void runTimed(const string& name, const vector<int>& keys) {
+    double best = 1e18;
+    long long found = 0;
+    for (int r = 0; r < 5; r++) {
+        found = 0;
+        best = min(best, timeMs([&] {
+            HashMap<int, long long, DefaultHash<int>, Storage> map;
+            for (int key : keys) map.set(key, key);
+            for (int key : keys) found += map.contains(key) + map.contains(key | 0x40000000);
+        }));
+    }
+    cout << "  " << name << ": " << best << " ms (" << found << " found)" << endl;
+}
+
+#ifdef HASHMAP_STATS
+// Fills a table of 2^20 buckets up to each load factor (below 0.75, so it never resizes) and prints its chains
+template<template<typename, typename, typename, typename> class Storage>
+void runLoadFactors(const string& name, const vector<int>& keys) {
+    const int buckets = 1 << 20;
+    cout << "  " << name << endl;
+    for (double load : {0.25, 0.5, 0.6, 0.7, 0.75}) {
+        HashMap<int, long long, DefaultHash<int>, Storage> map(buckets);
+        for (int i = 0; i < load * buckets; i++) map.set(keys[i], i);
+        HashMapStats stats = map.stats();
+        cout << "    load " << stats.loadFactor << ": average probe " << stats.averageProbe << ", longest " << stats.maxChain
+             << ", rehashes " << stats.rehashes << endl;
+    }
+}
+
+void runGraph() {
+    ifstream file("../AoC11/text/AoC11.txt");
+    Graph<string> graph;
+    string line;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string from, to;
+        ss >> from;
+        from.pop_back(); // The ':' after the name
+        while (ss >> to) graph.addEdge(from, to);
+    }
+    cout << "Paths you -> out: " << graph.countPathsRecursive("you", "out") << endl;
+    cout << graph.statsJson() << endl;
+    cout << "Paths svr -> out through dac and fft: " << graph.countPathsThrough2Recursive("svr", "out", "dac", "fft") << endl;
+    cout << graph.statsJson() << endl;
+}
+#endif
+
+int main() {
+    mt19937 rng(2025);
+    vector<int> keys(1000000);
+    for (int& key : keys) key = rng() & 0x3fffffff;
+
+#ifdef HASHMAP_STATS
+    cout << "AoC11 graph, statistics of all its maps" << endl;
+    runGraph();
+    cout << "Random int keys in 2^20 buckets" << endl;
+    runLoadFactors<ChainedTable>("ChainedTable", keys);
+    runLoadFactors<IncrementalTable>("IncrementalTable", keys);
+    runLoadFactors<FlatTable>("FlatTable", keys);
+    cout << "With HASHMAP_STATS: 10^6 inserts and 2 * 10^6 lookups (best of 5)" << endl;
+#else
+    cout << "Without HASHMAP_STATS: 10^6 inserts and 2 * 10^6 lookups (best of 5)" << endl;
+#endif
+    runTimed<ChainedTable>("ChainedTable    ", keys);
+    runTimed<IncrementalTable>("IncrementalTable", keys);
+    runTimed<FlatTable>("FlatTable       ", keys);
+    return 0;
+}
@@ -0,0 +1,240 @@
+// Benchmark that compares the two storage engines of our HashMap (ChainedTable vs FlatTable)
+// on the workloads we really have: the AoC7 memo table, the AoC11 graph and a big random insert/lookup test.
+
+#include "../../INCLUDE/Graph.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string_view>
+
+using namespace std;
+
+// Small helper to measure the time of a lambda in milliseconds
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+vector<string> readLines(const string& path) {
+    ifstream file(path);
+    vector<string> lines;
+    string line;
+    while (getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Same recursion as AoC7_P2.cpp but with the memo passed by reference so we can try every engine
+template<typename Map>
+long long countBeams(const vector<string>& grid, int row, int col, Map& memo) {
+    int rows = grid.size(), cols = grid[0].size();
+    if (col < 0 || col >= cols) return 0;
+    if (row == rows - 1) return 1;
+    int key = row * cols + col;
+    if (memo.contains(key)) return memo.get(key);
+    long long result = 0;
+    if (grid[row][col] == '^') {
+        result = countBeams(grid, row + 1, col - 1, memo) + countBeams(grid, row + 1, col + 1, memo);
+    } else if (grid[row][col] == '.' || grid[row][col] == 'S') {
+        result = countBeams(grid, row + 1, col, memo);
+    }
+    memo.set(key, result);
+    return result;
+}
+
+template<template<typename, typename, typename, typename> class Storage>
+void runAoC7(const string& name, const vector<string>& grid, int repetitions) {
+    int startCol = grid[0].find('S');
+    long long answer = 0;
+    double ms = timeMs([&] {
+        for (int r = 0; r < repetitions; r++) {
+            HashMap<int, long long, DefaultHash<int>, Storage> memo;
+            answer = countBeams(grid, 0, startCol, memo);
+        }
+    });
+    cout << "  " << name << ": " << ms / repetitions << " ms per run (answer " << answer << ")" << endl;
+}
+
+template<template<typename, typename, typename, typename> class Storage>
+void runAoC11(const string& name, const vector<string>& lines, int repetitions) {
+    Graph<string, int, int, Storage> graph;
+    double buildMs = timeMs([&] {
+        for (const string& line : lines) {
+            size_t dotsPos = line.find(':');
+            string node = line.substr(0, dotsPos);
+            istringstream iss(line.substr(dotsPos + 2));
+            string dep;
+            while (iss >> dep) graph.addEdge(node, dep);
+        }
+    });
+    long long p1 = 0, p2 = 0;
+    double queryMs = timeMs([&] {
+        for (int r = 0; r < repetitions; r++) {
+            p1 = graph.countPaths("you", "out");
+            p2 = graph.countPathsThrough2("svr", "out", "dac", "fft");
+        }
+    });
+    cout << "  " << name << ": build " << buildMs << " ms, queries " << queryMs / repetitions
+         << " ms per run (answers " << p1 << ", " << p2 << ")" << endl;
+}
+
+template<template<typename, typename, typename, typename> class Storage>
+void runRandom(const string& name, const vector<int>& keys) {
+    HashMap<int, long long, DefaultHash<int>, Storage> map;
+    double insertMs = timeMs([&] {
+        for (int k : keys) map.set(k, k);
+    });
+    long long hits = 0;
+    double lookupMs = timeMs([&] {
+        for (int k : keys) hits += map.contains(k) + map.contains(k ^ 0x40000000); // One hit and (almost always) one miss
+    });
+    cout << "  " << name << ": insert " << insertMs << " ms, lookup " << lookupMs << " ms (" << hits << " hits)" << endl;
+}
+
+// Many small queries on a small graph, here the cost of creating the maps of each query is what we measure
+template<template<typename, typename, typename, typename> class Storage>
+void runTinyQueries(const string& name, int repetitions) {
+    Graph<string, int, int, Storage> graph;
+    for (int i = 0; i < 10; i++) {
+        graph.addEdge("n" + to_string(i), "n" + to_string(i + 1));
+        graph.addEdge("n" + to_string(i), "n" + to_string(i + 2));
+    }
+    long long total = 0;
+    double ms = timeMs([&] {
+        for (int r = 0; r < repetitions; r++) {
+            total += graph.countPaths("n0", "n10");
+            total += graph.bfsShortestPath("n0", "n10").size();
+        }
+    });
+    cout << "  " << name << ": " << ms * 1000 / repetitions << " us per countPaths + bfsShortestPath (" << total << ")" << endl;
+}
+
+// String keys are the case where the control bytes help the most, every false probe used to be a full string compare
+void runStrings(const string& name, GroupProbe probe, const vector<string>& keys) {
+    activeGroupProbe() = probe;
+    HashMap<string, int, DefaultHash<string>, FlatTable> map;
+    for (size_t i = 0; i < keys.size(); i++) map.set(keys[i], i);
+    long long hits = 0;
+    double lookupMs = timeMs([&] {
+        for (int r = 0; r < 5; r++) {
+            for (const string& k : keys) hits += map.contains(k);
+            for (const string& k : keys) hits += map.contains(k + "#"); // Misses with the same prefix
+        }
+    });
+    cout << "  " << name << ": lookup " << lookupMs << " ms (" << hits << " hits)" << endl;
+}
+
+// A string that does not cache its hash in the engines, so we can measure the cached hash codes against the old behaviour
+struct UncachedString : string {
+    UncachedString() {}
+    UncachedString(const string& s) : string(s) {}
+};
+
+template<>
+struct CacheHashCode<UncachedString> : false_type {};
+
+struct UncachedStringHash {
+    unsigned long long operator()(const UncachedString& key) const {
+        return DefaultHash<string>()(key);
+    }
+};
+
+// Inserting grows the map several times (every resize rehashed all the strings before), then hits and misses with the same prefix
+template<typename Key, typename Hash, template<typename, typename, typename, typename> class Storage>
+void runCachedHash(const string& name, const vector<string>& names) {
+    vector<Key> keys(names.begin(), names.end());
+    vector<Key> misses;
+    for (const string& k : names) misses.push_back(Key(k + "#"));
+    HashMap<Key, int, Hash, Storage> map;
+    double insertMs = timeMs([&] {
+        for (size_t i = 0; i < keys.size(); i++) map.set(keys[i], i);
+    });
+    long long hits = 0;
+    double lookupMs = timeMs([&] {
+        for (int r = 0; r < 5; r++) {
+            for (const Key& k : keys) hits += map.contains(k);
+            for (const Key& k : misses) hits += map.contains(k);
+        }
+    });
+    cout << "  " << name << ": insert " << insertMs << " ms, lookup " << lookupMs << " ms (" << hits << " hits)" << endl;
+}
+
+// Probing a HashMap<string> with pieces of a line: building a std::string for each piece (what our parsers did before)
+// against passing the string_view directly (heterogeneous lookup)
+void runStringView(const vector<string>& names) {
+    HashMap<string, int, DefaultHash<string>, FlatTable> map;
+    string line; // All the names in one line separated by spaces, like an input file
+    for (size_t i = 0; i < names.size(); i++) {
+        if (i % 2 == 0) map.set(names[i], i); // Half of them are in the map
+        line += names[i] + " ";
+    }
+    for (int withView = 0; withView < 2; withView++) {
+        long long hits = 0;
+        double ms = timeMs([&] {
+            for (int r = 0; r < 5; r++) {
+                string_view rest(line);
+                while (!rest.empty()) {
+                    size_t spacePos = rest.find(' ');
+                    string_view name = rest.substr(0, spacePos);
+                    hits += withView ? map.contains(name) : map.contains(string(name));
+                    rest = rest.substr(spacePos + 1);
+                }
+            }
+        });
+        cout << "  " << (withView ? "string_view      " : "temporary string ") << ": " << ms << " ms (" << hits << " hits)" << endl;
+    }
+}
+
+int main() {
+    vector<string> grid = readLines("../AoC7/data/AoC7.txt");
+    vector<string> edges = readLines("../AoC11/text/AoC11.txt");
+
+    cout << "AoC7 memo (countPaths, 20 runs)" << endl;
+    runAoC7<ChainedTable>("ChainedTable", grid, 20);
+    runAoC7<FlatTable>("FlatTable   ", grid, 20);
+    runAoC7<DirectTable>("DirectTable ", grid, 20);
+
+    cout << "AoC11 graph (countPaths + countPathsThrough2, 20 runs)" << endl;
+    runAoC11<ChainedTable>("ChainedTable", edges, 20);
+    runAoC11<FlatTable>("FlatTable   ", edges, 20);
+
+    cout << "Tiny graph queries (12 nodes, 10^4 runs)" << endl;
+    runTinyQueries<ChainedTable>("ChainedTable", 10000);
+    runTinyQueries<FlatTable>("FlatTable   ", 10000);
+
+    mt19937 rng(2025);
+    vector<int> keys(1000000);
+    for (int& k : keys) k = rng() & 0x3fffffff;
+    cout << "Random int keys (10^6 inserts, 2 * 10^6 lookups)" << endl;
+    runRandom<ChainedTable>("ChainedTable", keys);
+    runRandom<FlatTable>("FlatTable   ", keys);
+
+    GroupProbe detected = activeGroupProbe();
+    vector<string> names(200000);
+    for (size_t i = 0; i < names.size(); i++) names[i] = "node_" + to_string(rng() % 100000000);
+    cout << "FlatTable group probing, 2 * 10^5 string keys (10^6 hits and 10^6 misses)" << endl;
+    runStrings("Scalar", GroupProbe::Scalar, names);
+    runStrings("SSE2  ", GroupProbe::SSE2, names);
+    if (detected == GroupProbe::AVX2) runStrings("AVX2  ", GroupProbe::AVX2, names);
+    activeGroupProbe() = detected;
+
+    vector<string> longNames(200000);
+    for (size_t i = 0; i < longNames.size(); i++) longNames[i] = "svr_dac_fft_state_" + to_string(rng() % 100000000);
+    cout << "Cached hash codes, 2 * 10^5 string keys with a long common prefix (10^6 hits and 10^6 misses)" << endl;
+    runCachedHash<UncachedString, UncachedStringHash, ChainedTable>("ChainedTable, no cache", longNames);
+    runCachedHash<string, DefaultHash<string>, ChainedTable>("ChainedTable, cached  ", longNames);
+    runCachedHash<UncachedString, UncachedStringHash, FlatTable>("FlatTable, no cache   ", longNames);
+    runCachedHash<string, DefaultHash<string>, FlatTable>("FlatTable, cached     ", longNames);
+
+    cout << "Heterogeneous lookup, 10^6 probes with names of 26 characters (longer than the small string buffer)" << endl;
+    runStringView(longNames);
+
+    return 0;
+}
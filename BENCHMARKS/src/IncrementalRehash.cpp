@@ -0,0 +1,51 @@
+// Worst case latency of one insertion while a map grows to 10^7 keys.
+// With ChainedTable and FlatTable the insertion that crosses the load factor rehashes every element, so the slowest
+// insertion grows with the size of the map. IncrementalTable moves a few buckets per operation instead.
+
+#include "../../INCLUDE/HashMap.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+// Times every set() of 'n' random keys and prints the total time, the slowest insertion and some percentiles
+template<template<typename, typename, typename, typename> class Storage>
+void runInsertions(const string& name, int n) {
+    HashMap<int, int, DefaultHash<int>, Storage> map;
+    vector<unsigned int> latencies(n); // Nanoseconds of each insertion
+    mt19937 rng(7);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        int key = static_cast<int>(rng());
+        auto before = chrono::steady_clock::now();
+        map.set(key, i);
+        auto after = chrono::steady_clock::now();
+        latencies[i] = static_cast<unsigned int>(chrono::duration_cast<chrono::nanoseconds>(after - before).count());
+    }
+    double totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    long long slowerThan1ms = count_if(latencies.begin(), latencies.end(), [](unsigned int ns) { return ns > 1000000; });
+    unsigned int worst = *max_element(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        size_t k = static_cast<size_t>(p * (n - 1));
+        nth_element(latencies.begin(), latencies.begin() + k, latencies.end());
+        return latencies[k];
+    };
+    unsigned int p50 = percentile(0.5);
+    unsigned int p9999 = percentile(0.9999);
+    cout << "  " << name << ": total " << totalMs << " ms, p50 " << p50 << " ns, p99.99 " << p9999 << " ns, worst "
+         << worst / 1e6 << " ms, insertions over 1 ms: " << slowerThan1ms << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? stoi(argv[1]) : 10000000; // The number of keys can be given as argument to make a quick run
+    cout << "Inserting " << n << " random int keys" << endl;
+    runInsertions<ChainedTable>("ChainedTable    ", n);
+    runInsertions<IncrementalTable>("IncrementalTable", n);
+    runInsertions<FlatTable>("FlatTable       ", n);
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Stress test of the 64-bit sizes: fills a HashMap<unsigned int, unsigned int, ..., FlatTable> (8-byte slots plus one
+// control byte) with n keys and looks them up again. Usage: ./programs/LargeTable [n] [grow]
+// By default n is 2 * 10^8, which fits in the 5 GB of our machine. The run the sizes were changed for is n = 3.2 * 10^9
+// (more than 2^31 entries and 2^32 slots), which needs about 39 GB with the table reserved up front and 58 GB when it grows
+// ("grow" as the second argument), because the old slot array still exists while the new one is filled. Before running a
+// size, the program prints the plan (slots and memory) and skips it when the machine does not have that much memory.
+
+#include "../../INCLUDE/HashMap.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace std;
+
+using Table = HashMap<unsigned int, unsigned int, DefaultHash<unsigned int>, FlatTable>;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Slots that the table will have for n keys, and its bytes (slot + control byte, plus the old array while growing)
+void plan(size_t n, bool grow, size_t& slots, double& gigabytes) {
+    slots = bucketsFor<PowerOfTwoGrowth>(n, 0.75);
+    double bytesPerSlot = sizeof(HashEntry<unsigned int, unsigned int>) + 1;
+    gigabytes = slots * bytesPerSlot * (grow ? 1.5 : 1.0) / 1e9;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000000;
+    bool grow = argc > 2 && string(argv[2]) == "grow";
+    double physicalGigabytes = static_cast<double>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE) / 1e9;
+
+    for (size_t target : {static_cast<size_t>(3200000000ULL), n}) {
+        size_t slots;
+        double gigabytes;
+        plan(target, grow, slots, gigabytes);
+        cout << target << " keys: " << slots << " slots (" << (slots > 0xffffffffULL ? "more than" : "up to") << " 2^32), "
+             << gigabytes << " GB" << (grow ? " while growing" : " reserved") << ", this machine has " << physicalGigabytes << " GB" << endl;
+    }
+    if (n > 0xffffffffULL) {
+        cout << "The keys are unsigned int, at most 2^32 different ones" << endl;
+        return 1;
+    }
+    size_t slots;
+    double gigabytes;
+    plan(n, grow, slots, gigabytes);
+    if (gigabytes > 0.9 * physicalGigabytes) {
+        cout << "Not enough memory for " << n << " keys, skipped" << endl;
+        return 0;
+    }
+
+    Table table;
+    double reserveMs = grow ? 0 : timeMs([&] { table.reserve(n); });
+    double insertMs = timeMs([&] {
+        for (size_t i = 0; i < n; i++) table.try_emplace(static_cast<unsigned int>(i), static_cast<unsigned int>(i ^ 0x5bd1e995));
+    });
+    size_t found = 0;
+    bool valuesOk = true;
+    const size_t lookups = min<size_t>(n, 100000000);
+    size_t step = n / lookups;
+    double hitMs = timeMs([&] {
+        for (size_t i = 0; i < n; i += step) {
+            const unsigned int* value = table.find(static_cast<unsigned int>(i));
+            found += value != nullptr;
+            valuesOk &= value != nullptr && *value == static_cast<unsigned int>(i ^ 0x5bd1e995);
+        }
+    });
+    size_t missing = 0;
+    double missMs = timeMs([&] { // Keys from n on were never inserted
+        for (size_t i = 0; i < lookups && n + i <= 0xffffffffULL; i++) missing += !table.contains(static_cast<unsigned int>(n + i));
+    });
+    cout << "Filled " << table.size() << " keys in " << table.bucketCount() << " slots" << (grow ? " (growing)" : "") << ": reserve "
+         << reserveMs << " ms, insert " << insertMs * 1e6 / n << " ns per key, lookup " << hitMs * 1e6 / found << " ns (" << found
+         << " found" << (valuesOk ? "" : ", WRONG values") << "), miss " << missMs * 1e6 / max<size_t>(missing, 1) << " ns ("
+         << missing << " missing)" << (table.size() == n ? "" : " WRONG size") << endl;
+    return 0;
+}
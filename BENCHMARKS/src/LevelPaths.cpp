@@ -0,0 +1,90 @@
+// Level synchronous path counting (countPathsLevels, countPathsThrough2Levels) with a ThreadPool of 1 to 64 threads, against
+// the sequential sweep (countPaths, countPathsThrough2). First the AoC11 graph, then two synthetic wide DAGs of 10^6 int
+// nodes: 50 levels of 20000 nodes and 1000 levels of 1000 nodes, every node with 1 to 4 edges to random nodes of the next
+// level. Usage: ./programs/LevelPaths [maximum threads], 64 by default. The results are checked against the sweep.
+
+#include "../../INCLUDE/Graph.h"
+#include "../../INCLUDE/ThreadPool.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template<typename F>
+double bestMs(int runs, F&& f) {
+    double best = 1e18;
+    for (int r = 0; r < runs; r++) best = min(best, timeMs(f));
+    return best;
+}
+
+// Times countPaths and countPathsThrough2 with the sweep and with pools of 1, 2, 4... threads
+template<typename Node>
+void scale(const Graph<Node>& graph, const Node& start, const Node& end, const Node& node1, const Node& node2, size_t maxThreads, int runs) {
+    long long paths = 0, through2 = 0;
+    double sweepMs = bestMs(runs, [&] { paths = graph.countPaths(start, end); });
+    double sweepThrough2Ms = bestMs(runs, [&] { through2 = graph.countPathsThrough2(start, end, node1, node2); });
+    cout << "  sweep: countPaths " << sweepMs << " ms, countPathsThrough2 " << sweepThrough2Ms << " ms" << endl;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        long long levelPaths = 0, levelThrough2 = 0;
+        double levelMs = bestMs(runs, [&] { levelPaths = graph.countPathsLevels(start, end, pool); });
+        double levelThrough2Ms = bestMs(runs, [&] { levelThrough2 = graph.countPathsThrough2Levels(start, end, node1, node2, pool); });
+        cout << "  " << threads << " threads: countPaths " << levelMs << " ms (" << sweepMs / levelMs << "x), countPathsThrough2 "
+             << levelThrough2Ms << " ms (" << sweepThrough2Ms / levelThrough2Ms << "x)"
+             << (levelPaths == paths && levelThrough2 == through2 ? "" : " DIFFERENT result") << endl;
+    }
+}
+
+void runAoC11(size_t maxThreads) {
+    ifstream file("../AoC11/text/AoC11.txt");
+    Graph<string> graph;
+    string line;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string from, to;
+        ss >> from;
+        from.pop_back(); // The ':' after the name
+        while (ss >> to) graph.addEdge(from, to);
+    }
+    cout << "AoC11 graph (" << graph.size() << " nodes, best of 20), svr -> out through dac and fft" << endl;
+    scale<string>(graph, "svr", "out", "dac", "fft", maxThreads, 20);
+}
+
+// levels * width nodes, node i of level l is l * width + i. A source (-1) points to the whole first level and the whole
+// last level points to a sink (-2), so every node is counted
+void runWide(int levels, int width, size_t maxThreads) {
+    mt19937 rng(25);
+    Graph<int> graph;
+    for (int i = 0; i < width; i++) graph.addEdge(-1, i);
+    for (int level = 0; level + 1 < levels; level++) {
+        for (int i = 0; i < width; i++) {
+            int degree = 1 + rng() % 4;
+            for (int d = 0; d < degree; d++) graph.addEdge(level * width + i, (level + 1) * width + static_cast<int>(rng() % width));
+        }
+    }
+    for (int i = 0; i < width; i++) graph.addEdge((levels - 1) * width + i, -2);
+    cout << "Wide DAG, " << levels << " levels of " << width << " nodes (best of 3)" << endl;
+    scale<int>(graph, -1, -2, width / 2, (levels - 1) * width - width / 3, maxThreads, 3);
+}
+
+int main(int argc, char** argv) {
+    size_t maxThreads = argc > 1 ? strtoull(argv[1], nullptr, 10) : 64;
+    cout << "This machine has " << thread::hardware_concurrency() << " cores" << endl;
+    runAoC11(maxThreads);
+    runWide(50, 20000, maxThreads);
+    runWide(1000, 1000, maxThreads);
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Memory and speed of a Graph<string> now that the nodes are interned (NodeInterner.h, every node is a 32-bit id inside
+// the Graph and its name is stored once). We count the bytes of the heap that are still in use after the build (replacing
+// the global operator new and asking malloc for the real size of every block) and divide them by the number of nodes, and
+// time the build, countPaths with a reused memo, hasNode and getForwardNeighbors. First the AoC11 graph, then a random DAG
+// of 10^6 nodes with 1 to 4 edges each, once with short names (8 characters, they fit in the std::string) and once with
+// long ones (24 characters, a heap block per std::string copy).
+// The same program built against the Graph.h before the interning gives the "before" column of the Readme.
+
+#include "../../INCLUDE/Graph.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+using namespace std;
+
+// Bytes of the heap in use, every allocation of the program goes through here
+static size_t liveBytes = 0;
+
+// The plain and the aligned operator new both take their blocks from malloc (aligned_alloc is a malloc block too), so every
+// operator delete gives them back with free. They are not inlined: GCC sees the free of a block that came from new at the
+// call sites and warns (-Wmismatched-new-delete), although here new and delete are both ours
+[[gnu::noinline]] static void* allocate(size_t size, size_t alignment) {
+    void* p = alignment <= alignof(max_align_t) ? malloc(size) : aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (p == nullptr) throw bad_alloc();
+    liveBytes += malloc_usable_size(p);
+    return p;
+}
+
+[[gnu::noinline]] static void release(void* p) noexcept {
+    if (p != nullptr) liveBytes -= malloc_usable_size(p);
+    free(p);
+}
+
+void* operator new(size_t size) {
+    return allocate(size, alignof(max_align_t));
+}
+
+void* operator new(size_t size, align_val_t alignment) { // The pmr containers of the Graph use the aligned version
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    release(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    release(p);
+}
+
+void operator delete(void* p, align_val_t) noexcept {
+    release(p);
+}
+
+void operator delete(void* p, size_t, align_val_t) noexcept {
+    release(p);
+}
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template<typename F>
+double bestMs(int runs, F&& f) {
+    double best = 1e18;
+    for (int r = 0; r < runs; r++) best = min(best, timeMs(f));
+    return best;
+}
+
+void run(const string& name, const vector<pair<string, string>>& edges, const vector<string>& starts, const string& target, int runs) {
+    size_t before = liveBytes;
+    Graph<string>* graph = nullptr;
+    double buildMs = timeMs([&] {
+        graph = new Graph<string>();
+        for (const auto& [from, to] : edges) graph->addEdge(from, to);
+    });
+    size_t bytes = liveBytes - before;
+    size_t nodes = graph->size();
+
+    Graph<string>::PathsMemo memo;
+    long long paths = 0;
+    double pathsMs = bestMs(runs, [&] {
+        paths = 0;
+        for (const string& start : starts) paths += graph->countPaths(start, target, memo);
+    });
+    vector<string> all = graph->getAllNodes();
+    size_t found = 0;
+    double hasNodeMs = bestMs(runs, [&] {
+        found = 0;
+        for (const string& node : all) found += graph->hasNode(node);
+    });
+    size_t neighbors = 0;
+    double neighborsMs = bestMs(runs, [&] {
+        neighbors = 0;
+        for (const string& node : all) neighbors += graph->getForwardNeighbors(node).size();
+    });
+
+    cout << name << " (" << nodes << " nodes, " << edges.size() << " edges): " << bytes / nodes << " bytes per node ("
+         << bytes / 1024 << " KB), build " << buildMs << " ms" << endl;
+    cout << "  countPaths: " << pathsMs << " ms (" << paths << " paths), hasNode on every node: " << hasNodeMs
+         << " ms, getForwardNeighbors on every node: " << neighborsMs << " ms (" << neighbors << " neighbors)"
+         << (found == nodes ? "" : " MISSING nodes") << endl;
+    delete graph;
+}
+
+void runAoC11() {
+    ifstream file("../AoC11/text/AoC11.txt");
+    vector<pair<string, string>> edges;
+    vector<string> starts;
+    string line;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string from, to;
+        ss >> from;
+        from.pop_back(); // The ':' after the name
+        starts.push_back(from);
+        while (ss >> to) edges.emplace_back(from, to);
+    }
+    run("AoC11", edges, starts, "out", 20);
+}
+
+// Name of the node i with the given length (zeros on the left), as a long label of a real input would be
+string label(int i, size_t length) {
+    string digits = to_string(i);
+    return "n" + string(length - 1 - digits.size(), '0') + digits;
+}
+
+void runRandom(size_t length) {
+    const int n = 1000000;
+    mt19937 rng(23);
+    vector<pair<string, string>> edges;
+    for (int from = 0; from < n - 1; from++) {
+        int degree = 1 + rng() % 4;
+        for (int d = 0; d < degree; d++) {
+            int to = from + 1 + rng() % min(1000, n - 1 - from); // Always to a bigger node, so there are no cycles
+            edges.emplace_back(label(from, length), label(to, length));
+        }
+    }
+    run("Random DAG, names of " + to_string(length) + " characters", edges, {label(0, length)}, label(n - 1, length), 3);
+}
+
+int main() {
+    runAoC11();
+    runRandom(8);
+    runRandom(24);
+    return 0;
+}
@@ -0,0 +1,123 @@
+// countPaths and countPathsThrough2 of the Graph: the sweep in reverse topological order (the default now) against the
+// recursive DFS with a memo HashMap (countPathsRecursive and countPathsThrough2Recursive). countPaths with a PathsMemo kept
+// by the caller is the same sweep on a reused scratch, it is timed too.
+// First the AoC11 graph (countPaths from every node to "out" and the part 2 query), then a random DAG of 10^6 int nodes with
+// 1 to 4 edges each, and then a chain of 10^6 nodes, where the recursion needs one stack frame per node. The recursive
+// versions only run on the chain when the program gets "deep" as its argument, as they overflow the 8 MB stack.
+
+#include "../../INCLUDE/Graph.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template<typename F>
+double bestMs(int runs, F&& f) {
+    double best = 1e18;
+    for (int r = 0; r < runs; r++) best = min(best, timeMs(f));
+    return best;
+}
+
+// One row: the time of each version and whether all of them gave the same result
+void row(const string& name, double sweepMs, double recursiveMs, double memoMs, bool same) {
+    cout << "  " << name << ": sweep " << sweepMs << " ms, recursive " << recursiveMs << " ms";
+    if (memoMs >= 0) cout << ", sweep with PathsMemo " << memoMs << " ms";
+    cout << (same ? "" : " DIFFERENT result") << endl;
+}
+
+void runAoC11() {
+    ifstream file("../AoC11/text/AoC11.txt");
+    Graph<string> graph;
+    string line;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string from, to;
+        ss >> from;
+        from.pop_back(); // The ':' after the name
+        while (ss >> to) graph.addEdge(from, to);
+    }
+    cout << "AoC11 graph (" << graph.size() << " nodes, best of 20)" << endl;
+    vector<string> nodes = graph.getAllNodes();
+    Graph<string>::PathsMemo memo;
+    long long sweepTotal = 0, recursiveTotal = 0, memoTotal = 0;
+    double sweepMs = bestMs(20, [&] {
+        sweepTotal = 0;
+        for (const string& node : nodes) sweepTotal += graph.countPaths(node, "out");
+    });
+    double recursiveMs = bestMs(20, [&] {
+        recursiveTotal = 0;
+        for (const string& node : nodes) recursiveTotal += graph.countPathsRecursive(node, "out");
+    });
+    double memoMs = bestMs(20, [&] {
+        memoTotal = 0;
+        for (const string& node : nodes) memoTotal += graph.countPaths(node, "out", memo);
+    });
+    row("countPaths(node, \"out\") for every node", sweepMs, recursiveMs, memoMs,
+        sweepTotal == recursiveTotal && sweepTotal == memoTotal);
+
+    long long sweepPaths = 0, recursivePaths = 0;
+    sweepMs = bestMs(20, [&] { sweepPaths = graph.countPathsThrough2("svr", "out", "dac", "fft"); });
+    recursiveMs = bestMs(20, [&] { recursivePaths = graph.countPathsThrough2Recursive("svr", "out", "dac", "fft"); });
+    row("countPathsThrough2(\"svr\", \"out\", \"dac\", \"fft\")", sweepMs, recursiveMs, -1, sweepPaths == recursivePaths);
+}
+
+void runRandom() {
+    const int n = 1000000;
+    mt19937 rng(24);
+    Graph<int> graph;
+    for (int from = 0; from < n - 1; from++) {
+        int degree = 1 + rng() % 4;
+        for (int d = 0; d < degree; d++) {
+            graph.addEdge(from, from + 1 + rng() % min(1000, n - 1 - from)); // Always to a bigger node, so there are no cycles
+        }
+    }
+    cout << "Random DAG (" << n << " nodes, best of 3)" << endl;
+    Graph<int>::PathsMemo memo;
+    long long sweepPaths = 0, recursivePaths = 0, memoPaths = 0;
+    double sweepMs = bestMs(3, [&] { sweepPaths = graph.countPaths(0, n - 1); });
+    double recursiveMs = bestMs(3, [&] { recursivePaths = graph.countPathsRecursive(0, n - 1); });
+    double memoMs = bestMs(3, [&] { memoPaths = graph.countPaths(0, n - 1, memo); });
+    row("countPaths(0, n - 1)", sweepMs, recursiveMs, memoMs, sweepPaths == recursivePaths && sweepPaths == memoPaths);
+
+    sweepMs = bestMs(3, [&] { sweepPaths = graph.countPathsThrough2(0, n - 1, n / 3, 2 * n / 3); });
+    recursiveMs = bestMs(3, [&] { recursivePaths = graph.countPathsThrough2Recursive(0, n - 1, n / 3, 2 * n / 3); });
+    row("countPathsThrough2(0, n - 1, n / 3, 2n / 3)", sweepMs, recursiveMs, -1, sweepPaths == recursivePaths);
+}
+
+void runChain(bool deep) {
+    const int n = 1000000;
+    Graph<int> graph;
+    for (int i = 0; i < n - 1; i++) graph.addEdge(i, i + 1);
+    cout << "Chain of " << n << " nodes" << endl;
+    long long paths = 0;
+    double sweepMs = timeMs([&] { paths = graph.countPaths(0, n - 1); });
+    cout << "  countPaths(0, n - 1): sweep " << sweepMs << " ms (" << paths << " path)" << endl;
+    Graph<int>::PathsMemo memo;
+    sweepMs = timeMs([&] { paths = graph.countPaths(0, n - 1, memo); });
+    cout << "  countPaths(0, n - 1, memo): sweep " << sweepMs << " ms (" << paths << " path)" << endl;
+    sweepMs = timeMs([&] { paths = graph.countPathsThrough2(0, n - 1, n / 3, 2 * n / 3); });
+    cout << "  countPathsThrough2(0, n - 1, n / 3, 2n / 3): sweep " << sweepMs << " ms (" << paths << " path)" << endl;
+    if (deep) {
+        cout << "  countPathsRecursive(0, n - 1): " << flush;
+        cout << graph.countPathsRecursive(0, n - 1) << endl; // Overflows the stack
+    }
+}
+
+int main(int argc, char** argv) {
+    runAoC11();
+    runRandom();
+    runChain(argc > 1 && string(argv[1]) == "deep");
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Adjacency lists of the Graph: std::vector (one heap block per node and direction) against SmallVector with 2, 3 and 4
+// inline neighbors. For each one we count the heap allocations made while building the graph (replacing the global
+// operator new) and time the build and the queries that walk the lists: countPaths (with a reused memo) and hasEdgeForward
+// on every edge. First the AoC11 graph (string nodes, countPaths from every node), then a random DAG of 10^6 int nodes with
+// 1 to 4 edges each (the same degrees as AoC11, countPaths from node 0 visits all of it), where the lists do not fit in the cache.
+
+#include "../../INCLUDE/Graph.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+// Every heap allocation of the program goes through here
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = malloc(size)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+template<typename T> using Small2 = SmallVector<T, 2>;
+template<typename T> using Small3 = SmallVector<T, 3>;
+template<typename T> using Small4 = SmallVector<T, 4>;
+template<typename T> using StdVector = vector<T>;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template<typename F>
+double bestMs(int runs, F&& f) {
+    double best = 1e18;
+    for (int r = 0; r < runs; r++) best = min(best, timeMs(f));
+    return best;
+}
+
+template<typename Node, template<typename> class List>
+void run(const string& name, const vector<pair<Node, Node>>& edges, const vector<Node>& starts, const Node& target, int runs) {
+    using G = Graph<Node, int, int, ChainedTable, List>;
+    size_t buildAllocations = 0;
+    double buildMs = bestMs(runs, [&] {
+        size_t before = allocations;
+        G graph;
+        for (const auto& [from, to] : edges) graph.addEdge(from, to);
+        buildAllocations = allocations - before;
+    });
+    G graph;
+    for (const auto& [from, to] : edges) graph.addEdge(from, to);
+
+    typename G::PathsMemo memo;
+    long long paths = 0;
+    double pathsMs = bestMs(runs, [&] {
+        paths = 0;
+        for (const Node& node : starts) paths += graph.countPaths(node, target, memo);
+    });
+    size_t found = 0;
+    double edgeMs = bestMs(runs, [&] {
+        found = 0;
+        for (const auto& [from, to] : edges) found += graph.hasEdgeForward(from, to);
+    });
+    cout << "  " << name << ": build " << buildMs << " ms (" << buildAllocations << " allocations), countPaths "
+         << pathsMs << " ms (" << paths << "), hasEdgeForward " << edgeMs << " ms (" << found << ")" << endl;
+}
+
+template<typename Node>
+void runAll(const vector<pair<Node, Node>>& edges, const vector<Node>& starts, const Node& target, int runs) {
+    run<Node, StdVector>("std::vector    ", edges, starts, target, runs);
+    run<Node, Small2>("SmallVector<2> ", edges, starts, target, runs);
+    run<Node, Small3>("SmallVector<3> ", edges, starts, target, runs);
+    run<Node, Small4>("SmallVector<4> ", edges, starts, target, runs);
+}
+
+int main() {
+    ifstream file("../AoC11/text/AoC11.txt");
+    vector<pair<string, string>> aocEdges;
+    string line;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string from, to;
+        ss >> from;
+        from.pop_back(); // The ':' after the name
+        while (ss >> to) aocEdges.emplace_back(from, to);
+    }
+    cout << "AoC11 graph (" << aocEdges.size() << " edges, string nodes, best of 20)" << endl;
+    Graph<string> aoc;
+    for (const auto& [from, to] : aocEdges) aoc.addEdge(from, to);
+    runAll<string>(aocEdges, aoc.getAllNodes(), "out", 20);
+
+    // Random DAG: the edges always go to a bigger node, so there are no cycles
+    const int n = 1000000;
+    mt19937 rng(19);
+    vector<pair<int, int>> randomEdges;
+    for (int from = 0; from < n - 1; from++) {
+        int degree = 1 + rng() % 4;
+        for (int d = 0; d < degree; d++) randomEdges.emplace_back(from, from + 1 + rng() % min(1000, n - 1 - from));
+    }
+    cout << "Random DAG (" << n << " nodes, " << randomEdges.size() << " edges, int nodes, best of 3)" << endl;
+    runAll<int>(randomEdges, {0}, n - 1, 3);
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Snapshots (Snapshot.h): how long it takes to have a memo ready by computing it again against mapping a snapshot written by
+// a previous run. First the memo of the AoC11 graph (paths from every node to "out", string keys), then a big memo of
+// random int keys. For the mapped file we time the open, the first lookup and two passes of lookups: the first one with the
+// file dropped from the page cache (every page is read from the disk) and the second one with all the pages in memory. To
+// compare with a format that has to be deserialized, we also time copying the mapped pairs into a new HashMap.
+// The files are written in programs/.
+
+#include "../../INCLUDE/Snapshot.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Asks the kernel to forget the pages of the file, so the next reads go to the disk. Without root we can not drop the
+// whole page cache, but the clean pages of one file can be dropped (if the file system supports it, tmpfs does not)
+void dropFromPageCache(const string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// Paths from node to "out", the memo of countPaths but keeping the count of every node
+long long pathsToOut(const HashMap<string, vector<string>>& adjacency, const string& node, HashMap<string, long long>& memo) {
+    if (const long long* cached = memo.find(node)) return *cached;
+    long long paths = node == "out" ? 1 : 0;
+    if (const vector<string>* neighbors = adjacency.find(node)) {
+        for (const string& neighbor : *neighbors) paths += pathsToOut(adjacency, neighbor, memo);
+    }
+    memo.set(node, paths);
+    return paths;
+}
+
+// Open, first lookup and the two passes over the queries of a snapshot
+template<typename K, typename Q>
+void timeMapped(const string& path, const vector<Q>& queries, long long expected) {
+    dropFromPageCache(path);
+    unique_ptr<MappedHashMap<K, long long>> mapped; // Not default constructible, so we can not declare it outside the lambda
+    double openMs = timeMs([&] { mapped = make_unique<MappedHashMap<K, long long>>(path); });
+    long long first = 0;
+    double firstMs = timeMs([&] { first = mapped->get(queries[0]); });
+    long long sumCold = 0, sumWarm = 0;
+    double coldMs = timeMs([&] {
+        for (const Q& query : queries) {
+            if (const long long* value = mapped->find(query)) sumCold += *value;
+        }
+    });
+    double warmMs = timeMs([&] {
+        for (const Q& query : queries) {
+            if (const long long* value = mapped->find(query)) sumWarm += *value;
+        }
+    });
+    double loadMs = timeMs([&] {
+        HashMap<K, long long> loaded;
+        loaded.reserve(mapped->size());
+        mapped->forEach([&](const auto& key, long long value) { loaded.set(K(key), value); });
+    });
+    cout << "  mapped: open " << openMs << " ms, first lookup " << firstMs * 1000 << " us (" << first << "), "
+         << queries.size() << " lookups " << coldMs << " ms from disk, " << warmMs << " ms in memory"
+         << (sumCold == expected && sumWarm == expected ? "" : " DIFFERENT result") << " (file " << mapped->fileBytes() / 1048576.0
+         << " MB)" << endl;
+    cout << "  loading it into a HashMap instead: " << loadMs << " ms" << endl;
+}
+
+void runAoC11() {
+    ifstream file("../AoC11/text/AoC11.txt");
+    HashMap<string, vector<string>> adjacency;
+    string line;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string from, to;
+        ss >> from;
+        from.pop_back(); // The ':' after the name
+        vector<string> neighbors;
+        while (ss >> to) neighbors.push_back(to);
+        adjacency.set(from, neighbors);
+    }
+    vector<string> queries;
+    adjacency.forEach([&](const string& node, const vector<string>&) { queries.push_back(node); });
+
+    HashMap<string, long long> memo;
+    double computeMs = timeMs([&] {
+        for (const string& node : queries) pathsToOut(adjacency, node, memo);
+    });
+    long long expected = 0;
+    for (const string& node : queries) expected += memo.get(node);
+    const string path = "programs/AoC11.snap";
+    double writeMs = timeMs([&] { writeSnapshot(memo, path); });
+    cout << "AoC11 memo (paths to out from " << memo.size() << " nodes, string keys)" << endl;
+    cout << "  computed in " << computeMs << " ms, snapshot written in " << writeMs << " ms" << endl;
+    timeMapped<string>(path, queries, expected);
+}
+
+void runRandom(int n) {
+    mt19937 rng(15);
+    HashMap<int, long long> memo;
+    vector<int> queries(n);
+    double buildMs = timeMs([&] {
+        for (int i = 0; i < n; i++) {
+            queries[i] = static_cast<int>(rng() & 0x7fffffff);
+            memo.set(queries[i], i);
+        }
+    });
+    shuffle(queries.begin(), queries.end(), rng);
+    long long expected = 0;
+    for (int query : queries) expected += memo.get(query);
+    const string path = "programs/Random.snap";
+    double writeMs = timeMs([&] { writeSnapshot(memo, path); });
+    cout << "Random int keys (" << memo.size() << " keys, every key looked up once in random order)" << endl;
+    cout << "  inserted in " << buildMs << " ms, snapshot written in " << writeMs << " ms" << endl;
+    timeMapped<int>(path, queries, expected);
+}
+
+// A hash that only looks at the length, so all the keys of the same length have the same full hash
+struct LengthHash {
+    unsigned long long operator()(string_view key) const {
+        return key.size();
+    }
+    size_t operator()(const string& key, size_t hashSize) const {
+        return key.size() % hashSize;
+    }
+};
+
+// writeSnapshot used to throw when two keys had the same hash ("Aa" and "BB" with the old string hash). Now the extra keys
+// go to the overflow slots, so every key must be found in the mapped file
+template<typename Hash>
+bool checkCollisions(const vector<string>& keys) {
+    HashMap<string, long long, Hash> map;
+    for (size_t i = 0; i < keys.size(); i++) map.set(keys[i], static_cast<long long>(i));
+    const string path = "programs/Collisions.snap";
+    writeSnapshot(map, path);
+    MappedHashMap<string, long long, Hash> mapped(path);
+    bool ok = mapped.size() == keys.size() && !mapped.contains("Ab") && !mapped.contains("Zzz");
+    for (size_t i = 0; i < keys.size(); i++) {
+        const long long* value = mapped.find(keys[i]);
+        ok = ok && value != nullptr && *value == static_cast<long long>(i);
+    }
+    return ok;
+}
+
+int main() {
+    vector<string> colliding = {"Aa", "BB", "C#", "out", "svr", "dac", "fft", "x"};
+    bool collisionsOk = checkCollisions<DefaultHash<string>>(colliding) && checkCollisions<LengthHash>(colliding);
+    cout << "Keys with the same hash: " << (collisionsOk ? "ok" : "WRONG result") << endl;
+    runAoC11();
+    runRandom(5000000);
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Visited sets: HashMap<K, bool> (what we used before) against HashSet<K> and DenseBitSet, on the two workloads where we
+// use them: a BFS over a graph and the per-row deduplication of AoC7_P1.
+
+#include "../../INCLUDE/HashSet.h"
+#include "../../INCLUDE/DenseBitSet.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+vector<string> readLines(const string& path) {
+    ifstream file(path);
+    vector<string> lines;
+    string line;
+    while (getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Adapters so the same BFS can run with every set type
+template<template<typename, typename, typename, typename> class Storage>
+struct MapVisited {
+    HashMap<int, bool, DefaultHash<int>, Storage> map;
+    MapVisited(int n) { map.reserve(n); }
+    bool insert(int node) { return map.try_emplace(node, true).second; }
+    void clear() { map.clear(); }
+};
+
+template<template<typename, typename, typename, typename> class Storage>
+struct SetVisited {
+    HashSet<int, DefaultHash<int>, Storage> set;
+    SetVisited(int n) { set.reserve(n); }
+    bool insert(int node) { return set.insert(node); }
+    void clear() { set.clear(); }
+};
+
+struct BitVisited {
+    DenseBitSet set;
+    BitVisited(int n) : set(n) {}
+    bool insert(int node) { return set.insert(node); }
+    void clear() { set.clear(); }
+};
+
+// BFS from node 0 on a random graph given as adjacency vectors, 'runs' times with the same visited set (cleared each time)
+template<typename Visited>
+void runBfs(const string& name, const vector<vector<int>>& adjacency, int runs) {
+    Visited visited(adjacency.size());
+    long long reached = 0;
+    double ms = timeMs([&] {
+        for (int r = 0; r < runs; r++) {
+            visited.clear();
+            queue<int> q;
+            q.push(0);
+            visited.insert(0);
+            while (!q.empty()) {
+                int current = q.front(); q.pop();
+                reached++;
+                for (int neighbor : adjacency[current]) {
+                    if (visited.insert(neighbor)) q.push(neighbor);
+                }
+            }
+        }
+    });
+    cout << "  " << name << ": " << ms / runs << " ms per BFS (" << reached / runs << " nodes reached)" << endl;
+}
+
+// The loop of AoC7_P1, the old version builds a HashMap<int, bool> per row
+template<typename Visited>
+void runAoC7Rows(const string& name, const vector<string>& grid, int runs, bool newSetPerRow) {
+    int rows = grid.size(), cols = grid[0].size();
+    int total = 0;
+    double ms = timeMs([&] {
+        for (int r = 0; r < runs; r++) {
+            total = 0;
+            vector<int> current = {static_cast<int>(grid[0].find('S'))};
+            Visited shared(cols + 2);
+            for (int row = 0; row < rows && !current.empty(); ++row) {
+                vector<int> next;
+                Visited perRow(newSetPerRow ? cols + 2 : 0);
+                Visited& seen = newSetPerRow ? perRow : shared;
+                seen.clear();
+                for (int col : current) {
+                    if (col < 0 || col >= cols) continue;
+                    char cell = grid[row][col];
+                    if (cell == '^') {
+                        if (row + 1 < rows) {
+                            if (seen.insert(col)) next.push_back(col - 1); // Stored as (col - 1) + 1
+                            if (seen.insert(col + 2)) next.push_back(col + 1);
+                        }
+                        total++;
+                    } else if ((cell == '.' || cell == 'S') && row + 1 < rows) {
+                        if (seen.insert(col + 1)) next.push_back(col);
+                    }
+                }
+                current.swap(next);
+            }
+        }
+    });
+    cout << "  " << name << ": " << ms * 1000 / runs << " us per run (answer " << total << ")" << endl;
+}
+
+int main() {
+    const int nodes = 200000;
+    mt19937 rng(11);
+    vector<vector<int>> adjacency(nodes);
+    for (int i = 0; i < nodes; i++) {
+        for (int k = 0; k < 4; k++) adjacency[i].push_back(rng() % nodes);
+    }
+    cout << "BFS on a random graph (2 * 10^5 nodes, 8 * 10^5 edges, 10 runs)" << endl;
+    runBfs<MapVisited<ChainedTable>>("HashMap<int, bool>, ChainedTable", adjacency, 10);
+    runBfs<SetVisited<ChainedTable>>("HashSet<int>, ChainedTable      ", adjacency, 10);
+    runBfs<MapVisited<FlatTable>>("HashMap<int, bool>, FlatTable   ", adjacency, 10);
+    runBfs<SetVisited<FlatTable>>("HashSet<int>, FlatTable         ", adjacency, 10);
+    runBfs<BitVisited>("DenseBitSet                     ", adjacency, 10);
+
+    vector<string> grid = readLines("../AoC7/data/AoC7.txt");
+    cout << "AoC7_P1 row deduplication (1000 runs)" << endl;
+    runAoC7Rows<MapVisited<ChainedTable>>("HashMap<int, bool> per row      ", grid, 1000, true);
+    runAoC7Rows<SetVisited<FlatTable>>("HashSet<int> (FlatTable) reused ", grid, 1000, false);
+    runAoC7Rows<BitVisited>("DenseBitSet reused              ", grid, 1000, false);
+    return 0;
+}
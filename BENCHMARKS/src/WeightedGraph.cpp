@@ -0,0 +1,41 @@
+// Building dense weighted graphs: every node gets an edge to 'degree' other nodes, so the time shows how the cost of one
+// addEdge grows with the degree of the node. Also times setWeight on every edge (it searches the list of the node).
+
+#include "../../INCLUDE/Graph.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+using namespace std;
+
+template<typename F>
+double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+void run(int nodes, int degree) {
+    Graph<int, int, int> graph(true, true, false); // Directed and weighted
+    long long edges = 1LL * nodes * degree;
+    double buildMs = timeMs([&] {
+        for (int from = 0; from < nodes; from++) {
+            for (int d = 1; d <= degree; d++) graph.addEdge(from, (from + d) % nodes, d);
+        }
+    });
+    // Only the first edge of every node, setWeight walks the list of the node until it finds it
+    double setMs = timeMs([&] {
+        for (int from = 0; from < nodes; from++) graph.setWeight(from, (from + 1) % nodes, 7);
+    });
+    cout << "  " << nodes << " nodes x degree " << degree << ": build " << buildMs << " ms (" << buildMs * 1e6 / edges
+         << " ns per edge), setWeight " << setMs * 1e6 / nodes << " ns per call" << endl;
+}
+
+int main() {
+    cout << "Dense weighted graphs (addEdge with weight)" << endl;
+    run(1000, 10);
+    run(1000, 100);
+    run(200, 1000);
+    run(20, 10000);
+    return 0;
+}
@@ -0,0 +1,231 @@
+// Memory resources for our containers (HashMap, HashSet, Graph and Tree).
+// Every one of them can take a std::pmr::memory_resource* in its constructor, and all the nodes, buckets and slots they
+// allocate come from it. By default it is the normal heap (new and delete), so nothing changes if you do not pass one.
+// Here we have the two resources that made sense for AoC:
+
+// Arena: bump pointer allocator. It takes big chunks from the heap and hands out consecutive pieces of them, an allocation
+// is just moving a pointer and a deallocation does nothing. All the memory is given back at once when the arena is reset
+// or destroyed. It is made for memory that dies all together: the memo of one query, or a tree that is built once and
+// then only searched.
+
+// NodePool: pool of blocks of one fixed size with a free list. It is made for node based containers where elements are
+// also removed (a Tree with remove(), a chained HashMap with erase()), a freed block is reused by the next allocation.
+// Requests bigger than the block size go to the heap.
+
+// Neither of them is thread safe, each thread (or each query) should have its own. The resource must live longer than the
+// containers that use it.
+
+#ifndef ALLOCATORS_H
+#define ALLOCATORS_H
+
+#include <memory_resource>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <new>
+
+class Arena : public std::pmr::memory_resource {
+    private:
+        // Every chunk starts with this header, the chunks form a list from the newest to the oldest
+        struct Chunk {
+            Chunk* previous;
+            size_t size; // Bytes of the chunk, header included
+        };
+
+        static constexpr size_t kMinChunk = 4096;
+
+        std::pmr::memory_resource* upstream; // Where the chunks come from
+        Chunk* current; // Newest chunk, the one we are cutting pieces from
+        char* cursor; // First free byte of the current chunk
+        char* end;
+        size_t nextChunkSize; // Every new chunk is twice as big as the previous one, so there are only O(log n) chunks
+        size_t used; // Bytes handed out since the last reset
+
+        static size_t paddingFor(const char* pointer, size_t alignment) {
+            return (alignment - reinterpret_cast<uintptr_t>(pointer) % alignment) % alignment;
+        }
+
+        void addChunk(size_t bytes, size_t alignment) {
+            size_t size = std::max(nextChunkSize, sizeof(Chunk) + bytes + alignment); // A big request gets a chunk of its own size
+            Chunk* chunk = new (upstream->allocate(size, alignof(std::max_align_t))) Chunk{current, size};
+            current = chunk;
+            cursor = reinterpret_cast<char*>(chunk + 1);
+            end = reinterpret_cast<char*>(chunk) + size;
+            nextChunkSize = size * 2;
+        }
+
+        // Frees the chunks from the current one until 'keep' (not included)
+        void freeChunksUntil(Chunk* keep) {
+            while (current != keep) {
+                Chunk* previous = current->previous;
+                upstream->deallocate(current, current->size, alignof(std::max_align_t));
+                current = previous;
+            }
+        }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            size_t padding = paddingFor(cursor, alignment);
+            if (current == nullptr || padding + bytes > static_cast<size_t>(end - cursor)) {
+                addChunk(bytes, alignment);
+                padding = paddingFor(cursor, alignment);
+            }
+            char* result = cursor + padding;
+            cursor = result + bytes;
+            used += bytes;
+            return result;
+        }
+
+        void do_deallocate(void*, size_t, size_t) override {} // The memory is only given back by reset(), release() or the destructor
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    public:
+        // initialChunk is the size of the first chunk, if we know how much a query needs we can get it in one allocation
+        explicit Arena(size_t initialChunk = kMinChunk, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : upstream(upstream), current(nullptr), cursor(nullptr), end(nullptr), nextChunkSize(std::max(initialChunk, sizeof(Chunk) * 2)), used(0) {}
+
+        Arena(const Arena&) = delete; // Two arenas can not own the same chunks
+        Arena& operator=(const Arena&) = delete;
+
+        ~Arena() {
+            release();
+        }
+
+        // Forgets everything that was allocated but keeps the newest chunk (the biggest one) for the next round, so an arena
+        // reused for every query stops calling the heap once it has grown enough. It costs O(number of chunks), not O(allocations)
+        void reset() {
+            if (current == nullptr) return;
+            Chunk* kept = current;
+            current = kept->previous;
+            freeChunksUntil(nullptr); // The older (smaller) chunks
+            kept->previous = nullptr;
+            current = kept;
+            cursor = reinterpret_cast<char*>(kept + 1);
+            used = 0;
+        }
+
+        // Gives all the chunks back to the heap
+        void release() {
+            freeChunksUntil(nullptr);
+            cursor = nullptr;
+            end = nullptr;
+            used = 0;
+        }
+
+        // Bytes handed out since the last reset (without the alignment padding)
+        size_t bytesUsed() const {
+            return used;
+        }
+
+        // Bytes taken from the heap (all the chunks)
+        size_t bytesReserved() const {
+            size_t total = 0;
+            for (Chunk* chunk = current; chunk != nullptr; chunk = chunk->previous) total += chunk->size;
+            return total;
+        }
+};
+
+class NodePool : public std::pmr::memory_resource {
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        // Blocks are carved from slabs, every slab starts with this header
+        struct Slab {
+            Slab* previous;
+            size_t size;
+        };
+
+        static constexpr size_t kMaxBlocksPerSlab = 4096;
+
+        std::pmr::memory_resource* upstream;
+        size_t blockSize; // Every block has this size and is aligned to max_align_t
+        FreeBlock* freeList; // Blocks that were given back, they are reused first
+        Slab* slabs;
+        char* cursor; // Blocks of the newest slab that were never handed out
+        char* end;
+        size_t blocksPerSlab; // Doubles with every slab up to kMaxBlocksPerSlab
+
+        // The same test is used to allocate and to deallocate, so a block always goes back where it came from
+        bool fits(size_t bytes, size_t alignment) const {
+            return bytes <= blockSize && alignment <= alignof(std::max_align_t);
+        }
+
+        void addSlab() {
+            size_t header = (sizeof(Slab) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+            size_t size = header + blocksPerSlab * blockSize;
+            Slab* slab = new (upstream->allocate(size, alignof(std::max_align_t))) Slab{slabs, size};
+            slabs = slab;
+            cursor = reinterpret_cast<char*>(slab) + header;
+            end = reinterpret_cast<char*>(slab) + size;
+            blocksPerSlab = std::min(blocksPerSlab * 2, kMaxBlocksPerSlab);
+        }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            if (!fits(bytes, alignment)) {
+                return upstream->allocate(bytes, alignment);
+            }
+            if (freeList != nullptr) {
+                FreeBlock* block = freeList;
+                freeList = block->next;
+                return block;
+            }
+            if (cursor == end) {
+                addSlab();
+            }
+            void* result = cursor;
+            cursor += blockSize;
+            return result;
+        }
+
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+            if (!fits(bytes, alignment)) {
+                upstream->deallocate(pointer, bytes, alignment);
+                return;
+            }
+            freeList = new (pointer) FreeBlock{freeList}; // O(1), the block goes to the front of the free list
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    public:
+        // blockSize is the biggest request served from the pool, for a Tree<T> it is sizeof(Node<T>). A bit more than needed
+        // is fine, for example 64 covers the list nodes of most HashMaps (their exact size depends on the standard library)
+        explicit NodePool(size_t blockSize, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : upstream(upstream), freeList(nullptr), slabs(nullptr), cursor(nullptr), end(nullptr), blocksPerSlab(32) {
+            size_t align = alignof(std::max_align_t);
+            this->blockSize = (std::max(blockSize, sizeof(FreeBlock)) + align - 1) / align * align;
+        }
+
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        ~NodePool() {
+            release();
+        }
+
+        // Gives every slab back to the heap at once, all the blocks become invalid. O(number of slabs)
+        void release() {
+            while (slabs != nullptr) {
+                Slab* previous = slabs->previous;
+                upstream->deallocate(slabs, slabs->size, alignof(std::max_align_t));
+                slabs = previous;
+            }
+            freeList = nullptr;
+            cursor = nullptr;
+            end = nullptr;
+        }
+
+        size_t getBlockSize() const {
+            return blockSize;
+        }
+};
+
+#endif
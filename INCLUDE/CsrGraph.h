@@ -0,0 +1,421 @@
+// CsrGraph: read-only version of a Graph built by graph.freeze(), for graphs that are built once and then queried many times
+// (AoC11 builds its graph and then only counts paths). In the Graph every neighbor of a traversal is a lookup in a HashMap
+// (its adjacency list) and every visited node one more lookup in the memo or visited table.
+// Here every node gets a dense id in [0, n) (the ids of the Graph without the removed nodes, so the order in which the nodes
+// were added), and the edges of all the nodes are stored in one array ordered by their source node (compressed sparse row):
+// the neighbors of the node u are forwardTargets[forwardOffsets[u] .. forwardOffsets[u + 1]). The backward edges are a second
+// pair of arrays, and the weights of a weighted graph one more array parallel to forwardTargets. A traversal never hashes:
+// the neighbors are ids that are next to each other in memory, and the memo of countPaths or the visited nodes of the BFS
+// are vectors indexed by id.
+// The nodes are only hashed to translate them to ids, once per query, with a FrozenHashMap.
+// UPDATE: The id map is now a NodeInterner (like the Graph), filled with the nodes in the order of their ids. The
+// FrozenHashMap took most of the time of freeze() and failed on two nodes with the same hash.
+// UPDATE 2: countPaths and countPathsThrough2 are the sweeps in reverse topological order of the Graph (countPathsIds), the
+// recursive DFS overflowed the stack on long chains.
+// It can not be modified: to change it, modify the Graph and freeze it again.
+
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include "Graph.h"
+#include "NodeInterner.h"
+#include <vector>
+#include <memory>
+#include <queue>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+
+// Same parameters as the Graph that builds it (the default WeightType is in the declaration in Graph.h)
+template<typename NodeType, typename WeightType>
+class CsrGraph {
+    public:
+        using NodeId = uint32_t; // 32-bit ids, the arrays of edges are half the size than with size_t (the offsets are size_t)
+        static constexpr NodeId kNoNode = numeric_limits<NodeId>::max();
+        using IdMap = NodeInterner<NodeType, FlatTable>; // Node -> id, the interned ids are the ids of the CsrGraph
+
+        // Neighbors of a node, a view of a part of the edge arrays (valid while the CsrGraph lives)
+        struct Neighbors {
+            const NodeId* first;
+            const NodeId* last;
+
+            const NodeId* begin() const { return first; }
+            const NodeId* end() const { return last; }
+            size_t size() const { return last - first; }
+            bool empty() const { return first == last; }
+            NodeId operator[](size_t i) const { return first[i]; }
+        };
+
+    private:
+        //========================================================================================================================
+        //                                                  Data Members
+        //========================================================================================================================
+
+        vector<NodeType> nodes; // nodes[id] is the node with that id
+        // And the way back, from the node to its id. The string interner can not be moved (its names point into its Arena), so
+        // it is behind a pointer, shared by the copies of the CsrGraph as nobody modifies it
+        shared_ptr<const IdMap> ids;
+        vector<size_t> forwardOffsets; // n + 1 positions, the edges of the node u are [forwardOffsets[u], forwardOffsets[u + 1])
+        vector<NodeId> forwardTargets; // Destination of every edge
+        vector<WeightType> weights; // Weight of every edge, parallel to forwardTargets (empty if the graph is not weighted)
+        vector<size_t> backwardOffsets; // Same for the edges that arrive to each node
+        vector<NodeId> backwardTargets; // Source of every edge, grouped by destination
+        bool isDirected = true;
+        bool isWeighted = false;
+
+        //========================================================================================================================
+        //                                                  Helpers
+        //========================================================================================================================
+
+        // The backward arrays are the forward ones transposed (counting sort by destination), so the sources of each node are
+        // sorted by id
+        void buildBackward() {
+            size_t n = nodes.size();
+            backwardOffsets.assign(n + 1, 0);
+            for (NodeId to : forwardTargets) backwardOffsets[to + 1]++;
+            for (size_t u = 0; u < n; u++) backwardOffsets[u + 1] += backwardOffsets[u];
+            backwardTargets.resize(forwardTargets.size());
+            vector<size_t> next(backwardOffsets.begin(), backwardOffsets.end() - 1);
+            for (size_t u = 0; u < n; u++) {
+                for (size_t e = forwardOffsets[u]; e < forwardOffsets[u + 1]; e++) {
+                    backwardTargets[next[forwardTargets[e]]++] = static_cast<NodeId>(u);
+                }
+            }
+        }
+
+        // The nodes that can be reached from start, in topological order, like Graph::reachableOrder: an iterative DFS counts
+        // the in-degrees of the reached part and then Kahn's algorithm orders it. The edges of end are not followed, the paths
+        // stop there. It throws if some reached node is in a cycle
+        vector<NodeId> reachableOrder(NodeId start, NodeId end) const {
+            size_t n = nodes.size();
+            vector<size_t> degrees(n, 0);
+            vector<char> reached(n, 0);
+            vector<NodeId> pending = {start};
+            reached[start] = 1;
+            size_t reachedCount = 1;
+            while (!pending.empty()) {
+                NodeId current = pending.back();
+                pending.pop_back();
+                if (current == end) continue;
+                for (NodeId neighbor : forwardNeighbors(current)) {
+                    degrees[neighbor]++;
+                    if (!reached[neighbor]) {
+                        reached[neighbor] = 1;
+                        reachedCount++;
+                        pending.push_back(neighbor);
+                    }
+                }
+            }
+            vector<NodeId> order; // Also the queue of Kahn's algorithm
+            order.reserve(reachedCount);
+            if (degrees[start] == 0) order.push_back(start);
+            for (size_t head = 0; head < order.size(); head++) {
+                if (order[head] == end) continue;
+                for (NodeId neighbor : forwardNeighbors(order[head])) {
+                    if (--degrees[neighbor] == 0) order.push_back(neighbor);
+                }
+            }
+            if (order.size() != reachedCount) {
+                throw runtime_error("The graph has a cycle that can be reached from the start node, the paths can not be counted.");
+            }
+            return order;
+        }
+
+        void requireDirected() const {
+            if (!isDirected) {
+                throw runtime_error("Graph must be directed to count paths using this method.");
+            }
+        }
+
+    public:
+        //========================================================================================================================
+        //                                                  Constructor
+        //========================================================================================================================
+        CsrGraph() : ids(make_shared<IdMap>()), forwardOffsets(1, 0), backwardOffsets(1, 0) {}
+
+        // Usually called through Graph::freeze(). index gives nodeList[id] the id id, offsets has nodes.size() + 1 positions and
+        // targets are ids of nodes, edgeWeights is parallel to targets if the graph is weighted and empty otherwise
+        CsrGraph(vector<NodeType>&& nodeList, shared_ptr<const IdMap> index, vector<size_t>&& offsets,
+                 vector<NodeId>&& targets, vector<WeightType>&& edgeWeights, bool directed, bool weighted)
+            : nodes(std::move(nodeList)), ids(std::move(index)), forwardOffsets(std::move(offsets)), forwardTargets(std::move(targets)),
+              weights(std::move(edgeWeights)), isDirected(directed), isWeighted(weighted) {
+            buildBackward();
+        }
+
+        //========================================================================================================================
+        //                                                  Ids
+        //========================================================================================================================
+
+        // Id of a node, it throws if the node is not in the graph. Q can also be a std::string_view or const char* for a
+        // CsrGraph<string> (the hash of std::string is transparent)
+        template<typename Q>
+        NodeId idOf(const Q& node) const {
+            const NodeId* id = ids->find(node);
+            if (id == nullptr) {
+                throw runtime_error("Node does not exist in the graph.");
+            }
+            return *id;
+        }
+
+        const NodeType& nodeOf(NodeId id) const {
+            return nodes[id];
+        }
+
+        Neighbors forwardNeighbors(NodeId id) const {
+            return {forwardTargets.data() + forwardOffsets[id], forwardTargets.data() + forwardOffsets[id + 1]};
+        }
+
+        Neighbors backwardNeighbors(NodeId id) const {
+            return {backwardTargets.data() + backwardOffsets[id], backwardTargets.data() + backwardOffsets[id + 1]};
+        }
+
+        // Weights of the forward edges of a node, parallel to forwardNeighbors(id) (only for weighted graphs)
+        const WeightType* forwardWeights(NodeId id) const {
+            return weights.data() + forwardOffsets[id];
+        }
+
+        //========================================================================================================================
+        //                                                  Algorithms
+        //========================================================================================================================
+
+        // Same as Graph::countPaths: one sweep over the nodes reached from start in reverse topological order, when we get to a
+        // node all its neighbors are done. Throws if the reached part has a cycle
+        long long countPaths(NodeId start, NodeId end) const {
+            requireDirected();
+            vector<NodeId> order = reachableOrder(start, end);
+            vector<unsigned long long> paths(nodes.size(), 0); // unsigned, the counts that do not fit wrap around like in the Graph
+            paths[end] = 1;
+            for (size_t i = order.size(); i-- > 0; ) {
+                NodeId current = order[i];
+                if (current == end) continue;
+                unsigned long long totalPaths = 0;
+                for (NodeId neighbor : forwardNeighbors(current)) totalPaths += paths[neighbor];
+                paths[current] = totalPaths;
+            }
+            return static_cast<long long>(paths[start]);
+        }
+
+        template<typename Q1, typename Q2>
+        long long countPaths(const Q1& start, const Q2& end) const {
+            return countPaths(idOf(start), idOf(end));
+        }
+
+        // Same as Graph::countPathsThrough2, paths from start to end that visit node1 and node2
+        template<typename Q1, typename Q2, typename Q3, typename Q4>
+        long long countPathsThrough2(const Q1& start, const Q2& end, const Q3& node1, const Q4& node2) const {
+            requireDirected();
+            NodeId startId = idOf(start);
+            NodeId endId = idOf(end);
+            const NodeId* required1 = ids->find(node1);
+            const NodeId* required2 = ids->find(node2);
+            if (required1 == nullptr || required2 == nullptr) {
+                return 0; // No path can visit a node that is not in the graph
+            }
+            // 4 counts per node, one for each pair of flags with which a path arrives: paths[4 * id + (visited1 | visited2 << 1)]
+            vector<NodeId> order = reachableOrder(startId, endId);
+            vector<unsigned long long> paths(4 * nodes.size(), 0);
+            paths[4 * size_t(endId) + 3] = 1; // Only a path that arrives with both flags counts
+            for (size_t i = order.size(); i-- > 0; ) {
+                NodeId current = order[i];
+                if (current == endId) continue;
+                unsigned here = (current == *required1) | (current == *required2) << 1; // The flags that this node sets
+                unsigned long long totalPaths[4] = {0, 0, 0, 0};
+                for (NodeId neighbor : forwardNeighbors(current)) {
+                    for (unsigned flags = 0; flags < 4; flags++) totalPaths[flags] += paths[4 * size_t(neighbor) + flags];
+                }
+                for (unsigned flags = 0; flags < 4; flags++) paths[4 * size_t(current) + flags] = totalPaths[flags | here];
+            }
+            return static_cast<long long>(paths[4 * size_t(startId)]);
+        }
+
+        // Same as Graph::bfsShortestPath, the nodes of the shortest path from start to end (empty if there is none)
+        template<typename Q1, typename Q2>
+        vector<NodeType> bfsShortestPath(const Q1& startNode, const Q2& endNode) const {
+            NodeId start = idOf(startNode);
+            NodeId end = idOf(endNode);
+            if (start == end) return {nodes[start]};
+            vector<NodeId> parent(nodes.size(), kNoNode); // kNoNode while the node is not visited
+            vector<NodeId> frontier; // The BFS queue, a vector that is never popped (head is the front)
+            frontier.push_back(start);
+            parent[start] = start;
+            bool found = false;
+            for (size_t head = 0; head < frontier.size() && !found; head++) {
+                NodeId current = frontier[head];
+                for (NodeId neighbor : forwardNeighbors(current)) {
+                    if (parent[neighbor] != kNoNode) continue;
+                    parent[neighbor] = current;
+                    if (neighbor == end) {
+                        found = true;
+                        break;
+                    }
+                    frontier.push_back(neighbor);
+                }
+            }
+            if (!found) return {};
+            vector<NodeType> path;
+            for (NodeId at = end; ; at = parent[at]) {
+                path.push_back(nodes[at]);
+                if (at == start) break;
+            }
+            reverse(path.begin(), path.end());
+            return path;
+        }
+
+        // Same as Graph::dijkstra, the distance to every node reached from start, in the order they are settled
+        template<typename Q>
+        vector<pair<NodeType, WeightType>> dijkstra(const Q& startNode) const {
+            if (!isWeighted) {
+                throw runtime_error("Graph is not weighted, cannot perform Dijkstra's algorithm.");
+            }
+            NodeId start = idOf(startNode);
+            priority_queue<pair<WeightType, NodeId>, vector<pair<WeightType, NodeId>>, greater<pair<WeightType, NodeId>>> pq;
+            vector<WeightType> distances(nodes.size());
+            vector<char> reached(nodes.size(), 0); // char and not bool, vector<bool> packs bits and every access is a shift
+            vector<char> settled(nodes.size(), 0);
+            vector<pair<NodeType, WeightType>> result;
+            pq.push({0, start});
+            distances[start] = 0;
+            reached[start] = 1;
+            while (!pq.empty()) {
+                auto [currentDist, current] = pq.top();
+                pq.pop();
+                if (settled[current]) continue;
+                settled[current] = 1;
+                result.emplace_back(nodes[current], currentDist);
+                for (size_t e = forwardOffsets[current]; e < forwardOffsets[current + 1]; e++) {
+                    NodeId neighbor = forwardTargets[e];
+                    WeightType newDist = currentDist + weights[e];
+                    if (!reached[neighbor] || newDist < distances[neighbor]) {
+                        reached[neighbor] = 1;
+                        distances[neighbor] = newDist;
+                        pq.push({newDist, neighbor});
+                    }
+                }
+            }
+            return result;
+        }
+
+        // Kahn's algorithm: a node goes out when all the nodes with an edge to it are out. The nodes in a cycle (and the nodes
+        // after them) never get there, so the result has fewer nodes than the graph if it is not a DAG
+        vector<NodeType> topologicalSort() const {
+            size_t n = nodes.size();
+            vector<size_t> degrees(n);
+            vector<NodeId> order; // Also the queue, like the BFS
+            order.reserve(n);
+            for (size_t u = 0; u < n; u++) {
+                degrees[u] = backwardOffsets[u + 1] - backwardOffsets[u];
+                if (degrees[u] == 0) order.push_back(static_cast<NodeId>(u));
+            }
+            for (size_t head = 0; head < order.size(); head++) {
+                for (NodeId next : forwardNeighbors(order[head])) {
+                    if (--degrees[next] == 0) order.push_back(next);
+                }
+            }
+            vector<NodeType> sortedOrder;
+            sortedOrder.reserve(order.size());
+            for (NodeId id : order) sortedOrder.push_back(nodes[id]);
+            return sortedOrder;
+        }
+
+        //========================================================================================================================
+        //                                                  Getters
+        //========================================================================================================================
+
+        template<typename Q>
+        bool hasNode(const Q& node) const {
+            return ids->find(node) != nullptr;
+        }
+
+        template<typename Q>
+        vector<NodeType> getForwardNeighbors(const Q& node) const {
+            vector<NodeType> result;
+            for (NodeId id : forwardNeighbors(idOf(node))) result.push_back(nodes[id]);
+            return result;
+        }
+
+        template<typename Q>
+        vector<NodeType> getBackwardNeighbors(const Q& node) const {
+            vector<NodeType> result;
+            for (NodeId id : backwardNeighbors(idOf(node))) result.push_back(nodes[id]);
+            return result;
+        }
+
+        template<typename Q>
+        size_t getInDegree(const Q& node) const {
+            return backwardNeighbors(idOf(node)).size();
+        }
+
+        template<typename Q>
+        size_t getOutDegree(const Q& node) const {
+            return forwardNeighbors(idOf(node)).size();
+        }
+
+        template<typename Q1, typename Q2>
+        bool hasEdgeForward(const Q1& from, const Q2& to) const {
+            Neighbors neighbors = forwardNeighbors(idOf(from));
+            return std::find(neighbors.begin(), neighbors.end(), idOf(to)) != neighbors.end();
+        }
+
+        template<typename Q1, typename Q2>
+        WeightType getWeight(const Q1& from, const Q2& to) const {
+            if (!isWeighted) throw runtime_error("Graph is not weighted, cannot get weights.");
+            NodeId fromId = idOf(from);
+            NodeId toId = idOf(to);
+            for (size_t e = forwardOffsets[fromId]; e < forwardOffsets[fromId + 1]; e++) {
+                if (forwardTargets[e] == toId) return weights[e];
+            }
+            throw runtime_error("Edge does not exist to get weight.");
+        }
+
+        // All the nodes, in the order of their ids
+        const vector<NodeType>& getAllNodes() const {
+            return nodes;
+        }
+
+        vector<NodeType> getRootNodes() const {
+            vector<NodeType> roots;
+            for (size_t u = 0; u < nodes.size(); u++) {
+                if (backwardOffsets[u] == backwardOffsets[u + 1]) roots.push_back(nodes[u]);
+            }
+            return roots;
+        }
+
+        vector<NodeType> getLeafNodes() const {
+            vector<NodeType> leaves;
+            for (size_t u = 0; u < nodes.size(); u++) {
+                if (forwardOffsets[u] == forwardOffsets[u + 1]) leaves.push_back(nodes[u]);
+            }
+            return leaves;
+        }
+
+        size_t size() const {
+            return nodes.size();
+        }
+
+        size_t getTotalNodes() const {
+            return nodes.size();
+        }
+
+        size_t edgeCount() const {
+            return forwardTargets.size();
+        }
+
+        bool directed() const {
+            return isDirected;
+        }
+
+        bool weighted() const {
+            return isWeighted;
+        }
+
+        // Bytes of the arrays and the id map (memory owned by the nodes themselves, like the characters of long strings, is not
+        // included, and the id map is counted as NodeInterner::memoryBytes counts it)
+        size_t memoryBytes() const {
+            return nodes.capacity() * sizeof(NodeType) + ids->memoryBytes() + (forwardOffsets.capacity() + backwardOffsets.capacity()) * sizeof(size_t)
+                + (forwardTargets.capacity() + backwardTargets.capacity()) * sizeof(NodeId) + weights.capacity() * sizeof(WeightType);
+        }
+};
+
+#endif
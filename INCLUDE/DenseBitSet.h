@@ -0,0 +1,102 @@
+// DenseBitSet: a set of small integers in [0, range), one bit per possible value.
+// When the keys are small integers (grid columns, node ids...) there is no need to hash them: contains and insert are one
+// bit operation on a vector of 64-bit words. It is made to be reused, for example one set for every row of a grid instead
+// of building a new HashMap per row: clear() only resets the words that were touched since the last clear, so its cost
+// depends on how many keys were inserted and not on the range.
+// UPDATE: The range, the keys and the size are size_t (they were int), like the sizes of the HashMap. A negative int key
+// becomes a huge size_t, so it is still out of the range: insert throws and contains returns false.
+
+#ifndef DENSE_BITSET_H
+#define DENSE_BITSET_H
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+class DenseBitSet {
+    private:
+        std::vector<uint64_t> words; // Bit i of word w is the key w * 64 + i
+        std::vector<size_t> touchedWords; // Words that got some bit set since the last clear, so clear() only resets them
+        std::vector<bool> isTouched; // One flag per word, so a word is never added twice to touchedWords
+        size_t range;
+        size_t count; // Number of keys in the set
+
+        void checkKey(size_t key) const {
+            if (key >= range) {
+                throw std::out_of_range("Key out of the range of the DenseBitSet");
+            }
+        }
+
+    public:
+        DenseBitSet(size_t range = 0) : words((range + 63) / 64, 0), isTouched(words.size(), false), range(range), count(0) {}
+
+        // Inserts the key, returns true if it was not in the set (same as HashSet::insert)
+        bool insert(size_t key) {
+            checkKey(key);
+            uint64_t& word = words[key >> 6];
+            uint64_t bit = uint64_t(1) << (key & 63);
+            if (word & bit) {
+                return false;
+            }
+            if (!isTouched[key >> 6]) {
+                isTouched[key >> 6] = true; // First bit of this word since the last clear, we remember it for clear()
+                touchedWords.push_back(key >> 6);
+            }
+            word |= bit;
+            count++;
+            return true;
+        }
+
+        bool contains(size_t key) const {
+            if (key >= range) return false; // A key out of the range can not be in the set
+            return (words[key >> 6] >> (key & 63)) & 1;
+        }
+
+        // Removes the key if it is in the set, returns true if it was removed
+        bool erase(size_t key) {
+            if (!contains(key)) return false;
+            words[key >> 6] &= ~(uint64_t(1) << (key & 63)); // The word stays in touchedWords, resetting it later is harmless
+            count--;
+            return true;
+        }
+
+        // Word-level reset of only the touched words. If more than a quarter of the words were touched we reset all of them at once
+        void clear() {
+            if (touchedWords.size() * 4 > words.size()) {
+                std::fill(words.begin(), words.end(), 0);
+                std::fill(isTouched.begin(), isTouched.end(), false);
+            } else {
+                for (size_t w : touchedWords) {
+                    words[w] = 0;
+                    isTouched[w] = false;
+                }
+            }
+            touchedWords.clear();
+            count = 0;
+        }
+
+        // Changes the range, the set is emptied
+        void resize(size_t newRange) {
+            words.assign((newRange + 63) / 64, 0);
+            isTouched.assign(words.size(), false);
+            touchedWords.clear();
+            range = newRange;
+            count = 0;
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        size_t getRange() const {
+            return range;
+        }
+};
+
+#endif
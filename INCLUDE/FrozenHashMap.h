@@ -0,0 +1,373 @@
+// FrozenHashMap: read-only map built once from a HashMap with map.freeze(), for tables that are filled at the beginning and
+// then only read millions of times (the adjacency lists of the AoC11 graph once it is built, for example).
+// It uses a minimal perfect hash function (PTHash style, "hash and displace"): the n keys are spread over n/4 small buckets,
+// and for every bucket we search a "pilot" number that sends all its keys to positions that no other key uses. With the
+// pilots stored, every key has its own position in [0, n), so the pairs are kept in an array of exactly n entries:
+// no empty slots, no chains and no probing. A lookup is one hash, one read of the pilot (a small array that stays in cache)
+// and one read of the entry, where we compare the key because a key that was not in the map also gets some position.
+// The index (the pilots and a small remap table) takes about 4.3 bits per key, see BENCHMARKS/Readme.md.
+// It can not be modified: to change it, build a HashMap again.
+// UPDATE: The perfect hash itself (the pilots) is now the PerfectHashIndex class, so the snapshots of Snapshot.h, which keep
+// the pilots in a file, use exactly the same positions.
+
+#ifndef FROZENHASHMAP_H
+#define FROZENHASHMAP_H
+
+#include "HashMap.h"
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <algorithm>
+
+//========================================================================================================================
+//                                                  PerfectHashIndex
+//========================================================================================================================
+// Given the hashes of n different keys, gives every one of them its own position in [0, n). It only knows the hashes, the
+// containers that use it (FrozenHashMap and the MappedHashMap of Snapshot.h) store the pairs in those positions.
+// UPDATE: Keys with the same hash get the same position, so the positions go up to the number of different hashes (size()).
+class PerfectHashIndex {
+    public:
+        // Everything a lookup needs besides the two arrays. Plain numbers, so a snapshot can write them to a file as they are
+        struct Params {
+            uint64_t keys = 0;
+            uint64_t buckets = 0;
+            uint64_t denseBuckets = 0; // The first 30% of the buckets, they get 60% of the keys
+            uint64_t tableSize = 0; // Positions used while searching the pilots (n / 0.99)
+            uint64_t salt = 0; // Depends on the seed that worked
+        };
+
+    private:
+        static constexpr double kKeysPerBucket = 4.0; // With 5 the index is 3.5 bits per key instead of 4.3, but the build is 1.6 times slower
+        static constexpr double kLoad = 0.99; // The positions go up to n / 0.99 while we search the pilots (see remap)
+        static constexpr int kMaxPilot = 65535; // The pilots are 16 bits
+        static constexpr int kMaxSeeds = 16; // If a bucket finds no pilot we start again with another seed
+
+        Params params;
+        std::vector<uint16_t> pilots; // Pilot of every bucket
+        // Searching the pilots with exactly n positions is very slow at the end (the last keys have to hit the last free
+        // positions), so we search them in n / 0.99 positions and then move the keys that got a position >= n to the free
+        // positions below n: remap[pos - n] is where the key of position pos really is
+        std::vector<uint32_t> remap;
+
+        // Maps a 64-bit value to [0, range) with a multiplication instead of a modulo (it uses the high bits)
+        static size_t reduce(unsigned long long x, size_t range) {
+            return static_cast<size_t>((static_cast<unsigned __int128>(x) * range) >> 64);
+        }
+
+        // Skewed buckets (like PTHash): 60% of the keys go to the first 30% of the buckets. Those big buckets are placed first
+        // while the table is empty, and the many small ones that are left are easy to place at the end
+        static size_t bucketOf(const Params& p, unsigned long long hash) {
+            unsigned long long rotated = (hash << 32) | (hash >> 32); // reduce uses the high bits, the choice below uses them too
+            // Written as selects and not as an if: the branch would be mispredicted 40% of the time
+            bool dense = hash < 0x999999999999999AULL; // 0.6 * 2^64
+            size_t first = dense ? 0 : p.denseBuckets;
+            size_t range = dense ? p.denseBuckets : p.buckets - p.denseBuckets;
+            return first + reduce(rotated, range);
+        }
+
+        // Position of a key with the given pilot before the remap. The multiplication by an odd constant is a bijection and
+        // the high bits that reduce takes depend on all the bits below them, so two keys of the same bucket with different
+        // hashes get different positions for almost every pilot (one multiplication instead of a full mix64, it is the hot path)
+        static size_t positionOf(const Params& p, unsigned long long hash, unsigned int pilot) {
+            return reduce((hash ^ (pilot * 0x9E3779B97F4A7C15ULL + p.salt)) * 0xc4ceb9fe1a85ec53ULL, p.tableSize);
+        }
+
+        // Searches a pilot for every bucket, from the biggest bucket to the smallest (they are the hardest to place, so they
+        // go first while most positions are free). Returns false if some bucket has no pilot that works
+        bool searchPilots(const std::vector<unsigned long long>& hashes, const std::vector<size_t>& bucketStart,
+                          const std::vector<size_t>& keysByBucket, const std::vector<size_t>& bucketOrder, std::vector<bool>& taken) {
+            taken.assign(params.tableSize, false);
+            std::vector<size_t> positions;
+            for (size_t bucket : bucketOrder) {
+                size_t begin = bucketStart[bucket], end = bucketStart[bucket + 1];
+                if (begin == end) break; // The rest of the buckets are empty too
+                bool found = false;
+                for (unsigned int pilot = 0; pilot <= kMaxPilot && !found; pilot++) {
+                    positions.clear();
+                    found = true;
+                    for (size_t k = begin; k < end && found; k++) {
+                        size_t position = positionOf(params, hashes[keysByBucket[k]], pilot);
+                        // Taken by another bucket or by a key of this bucket with this pilot (the buckets are small, a linear search is enough)
+                        found = !taken[position] && std::find(positions.begin(), positions.end(), position) == positions.end();
+                        positions.push_back(position);
+                    }
+                    if (found) pilots[bucket] = static_cast<uint16_t>(pilot);
+                }
+                if (!found) return false;
+                for (size_t position : positions) taken[position] = true;
+            }
+            return true;
+        }
+
+    public:
+        PerfectHashIndex() {}
+
+        // Builds the index for these hashes, equal hashes get the same position
+        explicit PerfectHashIndex(const std::vector<unsigned long long>& hashes) {
+            size_t n = hashes.size();
+            if (n == 0) return;
+            params.keys = n;
+            params.buckets = std::max<size_t>(2, static_cast<size_t>(n / kKeysPerBucket));
+            params.denseBuckets = std::max<size_t>(1, params.buckets * 3 / 10);
+            params.tableSize = std::max(n, static_cast<size_t>(n / kLoad));
+            size_t numBuckets = params.buckets;
+            pilots.assign(numBuckets, 0);
+
+            // Keys grouped by bucket (counting sort), the keys of bucket b are keysByBucket[bucketStart[b] .. bucketStart[b + 1])
+            std::vector<size_t> bucketStart(numBuckets + 1, 0);
+            for (size_t i = 0; i < n; i++) bucketStart[bucketOf(params, hashes[i]) + 1]++;
+            for (size_t b = 0; b < numBuckets; b++) bucketStart[b + 1] += bucketStart[b];
+            std::vector<size_t> keysByBucket(n);
+            std::vector<size_t> next(bucketStart.begin(), bucketStart.end() - 1);
+            for (size_t i = 0; i < n; i++) keysByBucket[next[bucketOf(params, hashes[i])]++] = i;
+
+            // UPDATE: Two keys with the same full hash get the same position with every pilot, no seed can separate them.
+            // Before we threw here, but different keys can have the same hash (with a weak string hash "Aa" and "BB" did), so
+            // now every hash is placed only once (equal hashes are always in the same bucket) and they share the position.
+            // The containers keep the other keys with that hash in a small overflow list
+            size_t kept = 0;
+            for (size_t b = 0; b < numBuckets; b++) {
+                size_t begin = kept;
+                for (size_t x = bucketStart[b]; x < bucketStart[b + 1]; x++) {
+                    bool repeated = false;
+                    for (size_t y = begin; y < kept && !repeated; y++) {
+                        repeated = hashes[keysByBucket[y]] == hashes[keysByBucket[x]];
+                    }
+                    if (!repeated) keysByBucket[kept++] = keysByBucket[x];
+                }
+                bucketStart[b] = begin;
+            }
+            bucketStart[numBuckets] = kept;
+            n = kept;
+            params.keys = n;
+            params.tableSize = std::max(n, static_cast<size_t>(n / kLoad));
+
+            // Buckets from the biggest to the smallest (counting sort by size, the sizes are small)
+            size_t maxSize = 0;
+            for (size_t b = 0; b < numBuckets; b++) maxSize = std::max(maxSize, bucketStart[b + 1] - bucketStart[b]);
+            std::vector<std::vector<size_t>> bySize(maxSize + 1);
+            for (size_t b = 0; b < numBuckets; b++) bySize[bucketStart[b + 1] - bucketStart[b]].push_back(b);
+            std::vector<size_t> bucketOrder;
+            bucketOrder.reserve(numBuckets);
+            for (size_t size = maxSize + 1; size-- > 0;) {
+                bucketOrder.insert(bucketOrder.end(), bySize[size].begin(), bySize[size].end());
+            }
+
+            std::vector<bool> taken;
+            for (int seed = 0; ; seed++) {
+                if (seed == kMaxSeeds) {
+                    throw std::runtime_error("PerfectHashIndex: could not build the perfect hash");
+                }
+                params.salt = mix64(static_cast<unsigned long long>(seed) + 1);
+                if (searchPilots(hashes, bucketStart, keysByBucket, bucketOrder, taken)) break;
+            }
+
+            // Keys that got a position >= n go to the free positions below n (there are as many of one as of the other)
+            remap.assign(params.tableSize - n, 0);
+            size_t freePosition = 0;
+            for (size_t position = n; position < params.tableSize; position++) {
+                if (!taken[position]) continue;
+                while (taken[freePosition]) freePosition++;
+                remap[position - n] = static_cast<uint32_t>(freePosition++);
+            }
+        }
+
+        // Position of a hash with an index given by its parts, used directly on the arrays of a mapped snapshot. A hash that
+        // was not in the index also gets a position, the caller has to compare the key stored there
+        static size_t position(const Params& p, const uint16_t* pilots, const uint32_t* remap, unsigned long long hash) {
+            size_t position = positionOf(p, hash, pilots[bucketOf(p, hash)]);
+            return position < p.keys ? position : remap[position - p.keys];
+        }
+
+        size_t position(unsigned long long hash) const {
+            return position(params, pilots.data(), remap.data(), hash);
+        }
+
+        size_t size() const {
+            return params.keys;
+        }
+
+        const Params& getParams() const {
+            return params;
+        }
+
+        const std::vector<uint16_t>& getPilots() const {
+            return pilots;
+        }
+
+        const std::vector<uint32_t>& getRemap() const {
+            return remap;
+        }
+
+        // Bits of the index per key
+        double bitsPerKey() const {
+            if (params.keys == 0) return 0;
+            return 8.0 * (pilots.size() * sizeof(uint16_t) + remap.size() * sizeof(uint32_t)) / params.keys;
+        }
+
+        size_t memoryBytes() const {
+            return pilots.capacity() * sizeof(uint16_t) + remap.capacity() * sizeof(uint32_t);
+        }
+};
+
+//========================================================================================================================
+//                                                  FrozenHashMap
+//========================================================================================================================
+// Same parameters as the HashMap that builds it (the default Hash is in the declaration in HashMap.h)
+template<typename K, typename T, typename Hash>
+class FrozenHashMap {
+    private:
+        // Like the engines of the HashMap, the entry keeps the full hash of non-scalar keys (see Cached hash codes in HashMap.h),
+        // so a lookup of a string that is not in the map almost never compares the strings
+        struct Entry : HashCache<K> {
+            HashEntry<K, T> kv;
+        };
+
+        std::vector<Entry> entries; // entries[i] is the pair whose key goes to position i
+        // Pairs whose key has the same full hash as the key of some entry (the index gives them the same position). Almost
+        // always empty, so a lookup only looks at it when the entry of its position had the same hash and another key
+        std::vector<Entry> overflow;
+        PerfectHashIndex index;
+        Hash hasher;
+
+        template<typename Q>
+        const T* findOverflow(const Q& key, unsigned long long hash) const {
+            for (const Entry& entry : overflow) {
+                if (entry.matchesHash(hash) && entry.kv.first == key) return &entry.kv.second;
+            }
+            return nullptr;
+        }
+
+    public:
+        FrozenHashMap() {}
+
+        // Builds the map from its pairs, the keys must be different. Usually called through HashMap::freeze()
+        explicit FrozenHashMap(std::vector<HashEntry<K, T>>&& pairs) {
+            size_t n = pairs.size();
+            if (n == 0) return;
+            std::vector<unsigned long long> hashes(n);
+            entries.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                hashes[i] = hasher(pairs[i].first);
+                entries[i].kv = std::move(pairs[i]);
+                entries[i].storeHash(hashes[i]);
+            }
+            pairs.clear();
+            index = PerfectHashIndex(hashes);
+
+            // The first pair of every position keeps it, the next ones with the same hash go to the overflow list
+            std::vector<size_t> target;
+            target.reserve(index.size());
+            std::vector<bool> used(index.size(), false);
+            for (size_t i = 0; i < n; i++) {
+                size_t position = index.position(hashes[i]);
+                if (used[position]) {
+                    overflow.push_back(std::move(entries[i]));
+                    continue;
+                }
+                used[position] = true;
+                if (target.size() != i) entries[target.size()] = std::move(entries[i]);
+                target.push_back(position);
+            }
+            entries.resize(target.size());
+            n = target.size();
+
+            // Every pair goes to its position. We follow the cycles of the permutation with swaps, so the pairs are moved
+            // and never copied
+            for (size_t i = 0; i < n; i++) {
+                while (target[i] != i) {
+                    size_t j = target[i];
+                    std::swap(entries[i], entries[j]);
+                    std::swap(target[i], target[j]);
+                }
+            }
+        }
+
+        // Returns a pointer to the value of the key, or nullptr if it is not in the map
+        const T* find(const K& key) const {
+            if (entries.empty()) return nullptr;
+            unsigned long long hash = hasher(key);
+            const Entry& entry = entries[index.position(hash)];
+            if (entry.matchesHash(hash)) {
+                if (entry.kv.first == key) return &entry.kv.second;
+                if (!overflow.empty()) return findOverflow(key, hash);
+            }
+            return nullptr;
+        }
+
+        bool contains(const K& key) const {
+            return find(key) != nullptr;
+        }
+
+        T get(const K& key) const {
+            return getRef(key);
+        }
+
+        const T& getRef(const K& key) const {
+            const T* value = find(key);
+            if (value == nullptr) {
+                throw std::runtime_error("Key not found");
+            }
+            return *value;
+        }
+
+        // Heterogeneous lookup, like in the HashMap only when the hash functor is transparent
+        template<typename Q, typename H = Hash, typename std::enable_if<IsTransparent<H>::value, int>::type = 0>
+        const T* find(const Q& key) const {
+            if (entries.empty()) return nullptr;
+            unsigned long long hash = hasher(key);
+            const Entry& entry = entries[index.position(hash)];
+            if (entry.matchesHash(hash)) {
+                if (entry.kv.first == key) return &entry.kv.second;
+                if (!overflow.empty()) return findOverflow(key, hash);
+            }
+            return nullptr;
+        }
+
+        template<typename Q, typename H = Hash, typename std::enable_if<IsTransparent<H>::value, int>::type = 0>
+        bool contains(const Q& key) const {
+            return find(key) != nullptr;
+        }
+
+        template<typename Q, typename H = Hash, typename std::enable_if<IsTransparent<H>::value, int>::type = 0>
+        const T& getRef(const Q& key) const {
+            const T* value = find(key);
+            if (value == nullptr) {
+                throw std::runtime_error("Key not found");
+            }
+            return *value;
+        }
+
+        template<typename Q, typename H = Hash, typename std::enable_if<IsTransparent<H>::value, int>::type = 0>
+        T get(const Q& key) const {
+            return getRef(key);
+        }
+
+        size_t size() const {
+            return entries.size() + overflow.size();
+        }
+
+        bool empty() const {
+            return entries.empty();
+        }
+
+        // Calls f(key, value) for every pair, in the order of their positions (and then the overflow list)
+        template<typename F>
+        void forEach(F&& f) const {
+            for (const Entry& entry : entries) f(entry.kv.first, entry.kv.second);
+            for (const Entry& entry : overflow) f(entry.kv.first, entry.kv.second);
+        }
+
+        // Bits of the index (pilots and remap table) per key, the pairs themselves are not counted
+        double bitsPerKey() const {
+            return index.bitsPerKey();
+        }
+
+        // Bytes of the whole map: the array of pairs plus the index (memory owned by the keys and values is not included)
+        size_t memoryBytes() const {
+            return (entries.capacity() + overflow.capacity()) * sizeof(Entry) + index.memoryBytes();
+        }
+};
+
+#endif
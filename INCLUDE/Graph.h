@@ -2,60 +2,162 @@
 #define GRAPH_H
 
 #include "HashMap.h"
+#include "HashSet.h"
+#include "ConcurrentHashMap.h"
+#include "Allocators.h"
+#include "SmallVector.h"
+#include "NodeInterner.h"
+#include "ThreadPool.h"
 #include <vector>
 #include <string>
 #include <queue>
-#include <set>
 #include <stdexcept>
 #include <algorithm>
 #include <tuple>
 #include <utility>
 #include <functional>
+#include <thread>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <exception>
 
 // IMPORTANT UPDATE 1: We now use getRef() method from HashMap to avoid unnecessary copying of vectors when getting adjacency lists, it returns
 // a const reference to the vector stored in the HashMap, improving performance. Changed in several places in the code below.
 
 using namespace std;
 
-template<typename NodeType, typename WeightType = int, typename NodeDataType = int>
+// Default adjacency list of the Graph: a SmallVector with 4 neighbors inside the entry of the map (95% of the nodes of AoC11 have
+// 4 or less), the nodes with more go to the heap like before
+template<typename T>
+using SmallAdjacency = SmallVector<T, 4>;
+
+// Read-only version of a Graph built by Graph::freeze(), defined in CsrGraph.h
+template<typename NodeType, typename WeightType = int>
+class CsrGraph;
+
+// UPDATE 2: The Storage parameter selects the HashMap engine used by every map of the graph (adjacency lists and memo tables),
+// ChainedTable is the original one and FlatTable is the open addressing one. Example: Graph<string, int, int, FlatTable>
+// UPDATE 3: The AdjacencyList parameter is the container of the forward, backward and weighted lists. SmallAdjacency by
+// default, std::vector gives the old behavior (one heap block per node). Example: Graph<string, int, int, ChainedTable, vector>
+// UPDATE 4: The nodes are interned (see NodeInterner.h): every node gets a dense 32-bit id when it is added, and all the maps,
+// lists and memo tables below use the ids. The nodes themselves are stored once, in the interner, and a node is only
+// translated to its id (one hash) when it crosses the public methods, which still take and return NodeType
+template<typename NodeType, typename WeightType = int, typename NodeDataType = int,
+         template<typename, typename, typename, typename> class Storage = ChainedTable,
+         template<typename> class AdjacencyList = SmallAdjacency>
 class Graph {
+    public:
+        using NodeId = typename NodeInterner<NodeType, Storage>::NodeId; // uint32_t
+
     private:
+        // The lists stored for every node (the public methods still return std::vector<NodeType>)
+        using NeighborList = AdjacencyList<NodeId>;
+        using WeightedList = AdjacencyList<pair<NodeId, WeightType>>;
+
+        // Shortcut for a HashMap that uses the storage engine chosen for this graph
+        template<typename K, typename V, typename Hash = DefaultHash<K>>
+        using Map = HashMap<K, V, Hash, Storage>;
+
+        // Same for the sets (visited nodes), they store no value
+        template<typename K, typename Hash = DefaultHash<K>>
+        using Set = HashSet<K, Hash, Storage>;
+
+        // Enables the heterogeneous overloads (std::string_view or const char* for a Graph<string>) only when the hash of
+        // NodeType is transparent. Node is always NodeType, it is a parameter so the condition is checked at each call
+        template<typename Node>
+        using IfTransparent = typename enable_if<IsTransparent<DefaultHash<Node>>::value, int>::type;
+
         //========================================================================================================================
         //                                                  Data Members
         //========================================================================================================================
 
-        HashMap<NodeType, vector<NodeType>> forwardAdjacents; // Adjacency list representation
-        HashMap<NodeType, vector<NodeType>> backwardAdjacents; // Reverse adjacency list
-        HashMap<NodeType, vector<pair<NodeType, WeightType>>> weightedAdjacents; // For weighted graphs if needed in the future, 
-                                                                                 // stores pairs of (neighbor, weight) for each node.
-        HashMap<NodeType, int> inDegrees; // To store in-degrees
-        set<NodeType> allNodes; // To store all unique nodes
-        HashMap<NodeType, NodeDataType> data; // To store data associated with each node
+        NodeInterner<NodeType, Storage> names; // Node <-> id, the only place where the nodes themselves are stored
+        pmr::vector<char> alive; // alive[id] is 1 while the node is in the graph (a removed node keeps its id, see NodeInterner.h)
+        size_t nodeCount = 0; // Number of ids with alive[id] == 1 (UPDATE: it replaces allNodes, a std::set of all the nodes)
+        Map<NodeId, NeighborList> forwardAdjacents; // Adjacency list representation
+        Map<NodeId, NeighborList> backwardAdjacents; // Reverse adjacency list
+        Map<NodeId, WeightedList> weightedAdjacents; // For weighted graphs if needed in the future, 
+                                                                             // stores pairs of (neighbor, weight) for each node.
+        Map<NodeId, size_t> inDegrees; // To store in-degrees
+        Map<NodeId, NodeDataType> data; // To store data associated with each node
         bool isWeighted = false; // Flag to indicate if the graph is weighted
         bool hasNodeData = false; // Flag to indicate if nodes have associated data
         bool isDirected = true; // Flag to indicate if the graph is directed
+#ifdef HASHMAP_STATS
+        mutable string lastQueryStats = "null"; // Statistics of the memo of the last recursive countPaths / countPathsThrough2 (see statsJson)
+#endif
         
         //========================================================================================================================
         //                                                  Helpers
         //========================================================================================================================
 
+        // Returns the id of a node of the graph, or nullptr if it is not in it. Q is NodeType, or a std::string_view or
+        // const char* for a Graph<string> (the interner searches them without building a std::string)
+        template<typename Q>
+        const NodeId* findId(const Q& node) const {
+            const NodeId* id = names.find(node);
+            return id != nullptr && alive[*id] ? id : nullptr;
+        }
+
+        // Gives the node an id if it has none and marks it as part of the graph. Q is NodeType, or a std::string_view for a
+        // Graph<string> (only a new name is copied, into the pool of the interner)
+        template<typename Q>
+        NodeId addNodeId(const Q& node) {
+            NodeId id = names.intern(node);
+            if (id == alive.size()) alive.push_back(0); // A new id is always the next one
+            if (!alive[id]) {
+                alive[id] = 1;
+                nodeCount++;
+            }
+            return id;
+        }
+
+        // Body of addEdge (from, to), for NodeType and for std::string_view nodes
+        template<typename Q>
+        void addUnweightedEdge(const Q& from, const Q& to) {
+            if (isWeighted) {
+                throw runtime_error("Graph is weighted, use addNode with weight parameter.");
+            }
+            // We create the nodes without data if they do not exist (UPDATE: and get their ids, one lookup each)
+            NodeId fromId = addNodeId(from);
+            NodeId toId = addNodeId(to);
+            addEdgeToGraph(fromId, toId);
+            if (!isDirected) {
+                addEdgeToGraph(toId, fromId); // For undirected graphs, we add the reverse edge
+            }
+        }
+
+        // The node with that id, for the methods that return nodes
+        NodeType nodeOf(NodeId id) const {
+            return NodeType(names.name(id));
+        }
+
+        vector<NodeType> nodesOf(const NeighborList* ids) const {
+            vector<NodeType> result;
+            if (ids == nullptr) return result;
+            result.reserve(ids->size());
+            for (NodeId id : *ids) result.push_back(nodeOf(id));
+            return result;
+        }
+
         // Helper for removing nodes
-        void removeNodeFromGraph(const NodeType& node) {
+        void removeNodeFromGraph(NodeId node) {
             // Remove all outgoing edges
             if (forwardAdjacents.contains(node)) {
-                const vector<NodeType>& neighbors = forwardAdjacents.getRef(node); // We get by reference to avoid copying (new method in HashMap)
-                                                                                   // const is used to avoid modifying the original vector, (The vector in the HashMap)
-                                                                                   // as we only need to read it here.
-                for (const NodeType& neighbor : neighbors) {
-                    removeEdge(node, neighbor); // Here e use removeEdge to handle outgoing edges
+                // UPDATE: Here we need a copy, removeEdge now modifies the lists in place and it removes from this same list
+                const NeighborList neighbors = forwardAdjacents.getRef(node);
+                for (NodeId neighbor : neighbors) {
+                    removeEdgeIds(node, neighbor); // Here e use removeEdge to handle outgoing edges
                 }
             }
 
             // Remove all incoming edges
             if (backwardAdjacents.contains(node)) {
-                const vector<NodeType>& neighbors = backwardAdjacents.getRef(node);
-                for (const NodeType& neighbor : neighbors) {
-                    removeEdge(neighbor, node); // Now we use removeEdge to handle incoming edges
+                const NeighborList neighbors = backwardAdjacents.getRef(node); // Copy for the same reason
+                for (NodeId neighbor : neighbors) {
+                    removeEdgeIds(neighbor, node); // Now we use removeEdge to handle incoming edges
                 }
             }
 
@@ -66,103 +168,101 @@ class Graph {
             if (weightedAdjacents.contains(node)) {
                 weightedAdjacents.remove(node); // Now we remove from weightedAdjacents if applicable 
             }
-            allNodes.erase(node);
+            alive[node] = 0; // The id stays in the interner, the node gets it back if it is added again
+            nodeCount--;
         }
 
         // Helper for adding edges
-        void addEdgeToGraph(const NodeType& from, const NodeType& to) {
-            forwardAdjacents.append(from, to); // We use the append method from our custom HashMap
-            backwardAdjacents.append(to, from);
-            int currentDegree = inDegrees.contains(to) ? inDegrees.get(to) : 0; // Here we get current in-degree
-            inDegrees.set(to, currentDegree + 1);
-            allNodes.insert(from); // We use a set to avoid duplicates
-            allNodes.insert(to);
+        void addEdgeToGraph(NodeId from, NodeId to) {
+            // UPDATE: upsert instead of append (append only exists for std::vector values), it is the same single lookup
+            forwardAdjacents.upsert(from, [&](NeighborList& neighbors) { neighbors.push_back(to); });
+            backwardAdjacents.upsert(to, [&](NeighborList& neighbors) { neighbors.push_back(from); });
+            inDegrees[to]++; // operator[] starts the in-degree at 0 if 'to' had no incoming edges (one single lookup)
         }
 
         // Helper method to add weighted edges to the graph
-        void addEdgeToGraph(const NodeType& from, const NodeType& to, const WeightType& weight) {
+        void addEdgeToGraph(NodeId from, NodeId to, const WeightType& weight) {
             // We add the edge to the adjacency lists
             addEdgeToGraph(from, to);
 
-            // Then we add the weighted edge to weightedAdjacents
-            // If 'from' does not exist yet in weightedAdjacents, we initialize it (empty vector)
-            if (!weightedAdjacents.contains(from)) {
-                weightedAdjacents.set(from, vector<pair<NodeType, WeightType>>());
-            }
-            // Finally we add the weighted edge
-            auto neighbors = weightedAdjacents.get(from);
-            neighbors.emplace_back(to, weight);
-            weightedAdjacents.set(from, move(neighbors));
+            // Then we add the weighted edge to weightedAdjacents. UPDATE: upsert creates the empty list if 'from' has none and
+            // pushes the edge in place, before we copied the whole list out and back for every edge (O(degree) per edge)
+            weightedAdjacents.upsert(from, [&](WeightedList& neighbors) { neighbors.emplace_back(to, weight); });
         }
 
         // Helper for removing edges
-        void removeFromAdjacencyList(const NodeType& from, const NodeType& to) {
+        void removeFromAdjacencyList(NodeId from, NodeId to) {
+            // UPDATE: The lists are modified in place with update(), before they were copied out and set back
             // We remove 'to' from the forward adjacency list of 'from'
-            if (forwardAdjacents.contains(from)) {
-                const vector<NodeType>& neighbors = forwardAdjacents.getRef(from);
+            forwardAdjacents.update(from, [&](NeighborList& neighbors) {
                 neighbors.erase(remove(neighbors.begin(), neighbors.end(), to), neighbors.end());
-                forwardAdjacents.set(from, neighbors);
-            }
+            });
             // We remove 'from' from the backward adjacency list of 'to'
-            if (backwardAdjacents.contains(to)) {
-                vector<NodeType> neighbors = backwardAdjacents.get(to);
+            backwardAdjacents.update(to, [&](NeighborList& neighbors) {
                 neighbors.erase(remove(neighbors.begin(), neighbors.end(), from), neighbors.end());
-                backwardAdjacents.set(to, neighbors);
-            }
+            });
             // We update the in-degree count for 'to'
-            if (inDegrees.contains(to)) {
-                int currentDegree = inDegrees.get(to);
-                if (currentDegree > 0) {
-                    inDegrees.set(to, currentDegree - 1);
-                }
+            if (size_t* degree = inDegrees.find(to)) {
+                if (*degree > 0) (*degree)--;
+            }
+            // The weighted edge goes too, otherwise getWeight would still find it
+            weightedAdjacents.update(from, [&](WeightedList& edges) {
+                edges.erase(remove_if(edges.begin(), edges.end(), [&](const pair<NodeId, WeightType>& e) { return e.first == to; }), edges.end());
+            });
+        }
+
+        // removeEdge once both nodes are ids
+        void removeEdgeIds(NodeId from, NodeId to) {
+            removeFromAdjacencyList(from, to);
+            if (!isDirected) {
+                removeFromAdjacencyList(to, from); // For undirected graphs, we remove the reverse edge
             }
         }
 
-        // Helper function for recursive DFS with memoization
-        long long countPathsHelper(const NodeType& current, const NodeType& target, 
-                                   HashMap<NodeType, long long>& memo) const {
-            // Check memo
-            if (memo.contains(current)) {
-                return memo.get(current);
+        // Helper function for recursive DFS with memoization (UPDATE: a template, so the memo can be a HashMap of any engine)
+        template<typename Memo>
+        long long countPathsHelper(NodeId current, NodeId target, Memo& memo) const {
+            // Check memo, find() hashes the key only once (before we did contains() and then get())
+            if (const long long* cached = memo.find(current)) {
+                return *cached;
             }
 
             // Base case: reached target
             if (current == target) {
-                memo.set(current, 1);
+                memo.try_emplace(current, 1);
                 return 1;
             }
             
             // Recursively count paths through all outgoing edges
             long long totalPaths = 0;
-            if (forwardAdjacents.contains(current)) {
-                const vector<NodeType>& neighbors = forwardAdjacents.getRef(current);
-                for (const NodeType& neighbor : neighbors) {
+            if (const NeighborList* neighbors = forwardAdjacents.find(current)) {
+                for (NodeId neighbor : *neighbors) {
                     totalPaths += countPathsHelper(neighbor, target, memo);
                 }
             }
             
-            // Memoize and return
-            memo.set(current, totalPaths);
-            return memo.get(current);
+            // Memoize and return. We cannot keep a pointer from the first lookup because the recursion inserts other keys
+            // (and the FlatTable may move its slots), but try_emplace does not need to search again after inserting
+            memo.try_emplace(current, totalPaths);
+            return totalPaths;
         }
 
         // Helper for counting paths that visit both required nodes (DFS). Explained in README
-        long long countPathsThrough2Helper(const NodeType& current, const NodeType& target,
-                                           const NodeType& node1, const NodeType& node2,
+        long long countPathsThrough2Helper(NodeId current, NodeId target, NodeId node1, NodeId node2,
                                            bool visited1, bool visited2,
-                                           HashMap<tuple<NodeType, bool, bool>, long long, TupleHash3<NodeType, bool, bool>>& memo) const {
+                                           Map<tuple<NodeId, bool, bool>, long long, TupleHash3<NodeId, bool, bool>>& memo) const {
             // Create state for memoization
-            tuple<NodeType, bool, bool> state = make_tuple(current, visited1, visited2); // make_tuple from <tuple>
+            tuple<NodeId, bool, bool> state = make_tuple(current, visited1, visited2); // make_tuple from <tuple>
             
             // We check memo first
-            if (memo.contains(state)) {
-                return memo.get(state);
+            if (const long long* cached = memo.find(state)) {
+                return *cached;
             }
             
             // Base case: reached target with both nodes visited
             if (current == target) {
                 long long result = (visited1 && visited2) ? 1 : 0; // We only count if both have been visited
-                memo.set(state, result); // Memoize base case
+                memo.try_emplace(std::move(state), result); // Memoize base case
                 return result;
             }
             
@@ -172,37 +272,62 @@ class Graph {
             
             // Recursively count paths through all outgoing edges
             long long totalPaths = 0;
-            if (forwardAdjacents.contains(current)) { // If the fordward adjacents contains the current node
-                const vector<NodeType>& neighbors = forwardAdjacents.getRef(current); // We get its neighbors
-                for (const NodeType& neighbor : neighbors) { // And we iterate through them
+            if (const NeighborList* neighbors = forwardAdjacents.find(current)) { // If the fordward adjacents contains the current node
+                for (NodeId neighbor : *neighbors) { // We iterate through its neighbors
                     totalPaths += countPathsThrough2Helper(neighbor, target, node1, node2, 
                                                           newVisited1, newVisited2, memo);
                 }
             }
             
-            // Memoize and return
-            memo.set(state, totalPaths);
+            // Memoize and return (the state is not needed anymore so we move it into the memo)
+            memo.try_emplace(std::move(state), totalPaths);
             return totalPaths;
         }
 
+        // Parallel version of countPathsHelper, the memo is shared by all the threads. Each thread walks the neighbors starting
+        // at a different position ('order'), so they go down different branches first and then reuse what the others computed.
+        // UPDATE: lists[id] is the forward list of every node, taken by the calling thread before the threads start. The
+        // threads must not call forwardAdjacents.find(): with -DHASHMAP_STATS it counts the lookup, and the IncrementalTable
+        // moves buckets while it searches
+        long long countPathsParallelHelper(NodeId current, NodeId target, const vector<const NeighborList*>& lists,
+                                           ConcurrentHashMap<NodeId, long long, DefaultHash<NodeId>, Storage>& memo, size_t order) const {
+            if (current == target) {
+                return 1; // Base case: reached target (no need to store it)
+            }
+            // get_or_compute runs the lambda only once per node, if another thread is computing it we wait for its result
+            return memo.get_or_compute(current, [&]() {
+                long long totalPaths = 0;
+                if (const NeighborList* neighbors = lists[current]) {
+                    size_t n = neighbors->size();
+                    for (size_t i = 0; i < n; i++) {
+                        totalPaths += countPathsParallelHelper((*neighbors)[(i + order) % n], target, lists, memo, order);
+                    }
+                }
+                return totalPaths;
+            });
+        }
+
         // BFS helper for shortest path
-        vector<NodeType> bfsShortestPathHelper(const NodeType& start, const NodeType& end) const {
-            if (start == end) return {start}; // Trivial case
+        vector<NodeType> bfsShortestPathHelper(NodeId start, NodeId end) const {
+            if (start == end) return {nodeOf(start)}; // Trivial case
 
-            HashMap<NodeType, bool> visited; // To track visited nodes
-            HashMap<NodeType, NodeType> parent; // To reconstruct the path
-            queue<NodeType> q; // BFS queue
+            Arena scratch; // Both tables only live during the search
+            Set<NodeId> visited(&scratch); // To track visited nodes (UPDATE: a HashSet, before it was a HashMap<NodeType, bool>)
+            Map<NodeId, NodeId> parent(&scratch); // To reconstruct the path
+            visited.reserve(nodeCount); // We know the maximum size, so the maps never resize during the search
+            parent.reserve(nodeCount);
+            queue<NodeId> q; // BFS queue
 
             q.push(start); // We push start node to the queue
-            visited.set(start, true); // We mark it as visited
+            visited.insert(start); // We mark it as visited
 
             bool found = false; // Flag to indicate if we found the end node
             while (!q.empty() && !found) { // While there are nodes to process and we haven't found the end
-                NodeType current = q.front(); q.pop(); // We get the front node and remove it from the queue
-                if (!forwardAdjacents.contains(current)) continue; // If there are no neighbors we must not check this node
-                for (const NodeType& neighbor : forwardAdjacents.getRef(current)) { // We iterate through its neighbors
-                    if (visited.contains(neighbor)) continue; // If already visited, skip
-                    visited.set(neighbor, true); // We mark it as visited
+                NodeId current = q.front(); q.pop(); // We get the front node and remove it from the queue
+                const NeighborList* neighbors = forwardAdjacents.find(current);
+                if (neighbors == nullptr) continue; // If there are no neighbors we must not check this node
+                for (NodeId neighbor : *neighbors) { // We iterate through its neighbors
+                    if (!visited.insert(neighbor)) continue; // If already visited, skip (else it is marked now)
                     parent.set(neighbor, current); // We set its parent for path reconstruction
                     if (neighbor == end) { // If we found the end node, we stop
                         found = true;
@@ -217,8 +342,8 @@ class Graph {
 
             // Else we reconstruct the path from end to start using the parent map
             vector<NodeType> path;
-            for (NodeType at = end; /* NO CONDITION */ ; at = parent.get(at)) { // We go backwards from end to start
-                path.push_back(at);
+            for (NodeId at = end; /* NO CONDITION */ ; at = parent.get(at)) { // We go backwards from end to start
+                path.push_back(nodeOf(at));
                 if (at == start) break;
             }
             reverse(path.begin(), path.end()); // We reverse the path to get it from start to end
@@ -226,11 +351,14 @@ class Graph {
         }
 
         // We will add a Dijkstra helper just for educational purposes, not used in AoC11
-        vector<pair<NodeType, WeightType>> dijkstraHelper(const NodeType& start) const {
+        vector<pair<NodeType, WeightType>> dijkstraHelper(NodeId start) const {
             // We use a priority queue to store (distance, node)
-            priority_queue<pair<WeightType, NodeType>, vector<pair<WeightType, NodeType>>, greater<pair<WeightType, NodeType>>> pq;
-            HashMap<NodeType, WeightType> distances; // To store shortest distances (or whatever WeightType is)
-            HashMap<NodeType, bool> visited; // To track visited nodes
+            priority_queue<pair<WeightType, NodeId>, vector<pair<WeightType, NodeId>>, greater<pair<WeightType, NodeId>>> pq;
+            Arena scratch;
+            Map<NodeId, WeightType> distances(&scratch); // To store shortest distances (or whatever WeightType is)
+            Set<NodeId> visited(&scratch); // To track visited nodes
+            distances.reserve(nodeCount);
+            visited.reserve(nodeCount);
             vector<pair<NodeType, WeightType>> result; // To store final distances 
             // Initialize
             pq.push({0, start}); // We start with distance 0 at start node
@@ -238,17 +366,17 @@ class Graph {
             while (!pq.empty()) { // While there are nodes to process:
                 auto [currentDist, currentNode] = pq.top(); // We get the node with the smallest distance
                 pq.pop(); // We remove it from the queue
-                if (visited.contains(currentNode)) { // We check if we have already processed this node
-                    continue; // Already processed
+                if (!visited.insert(currentNode)) { // We check if we have already processed this node
+                    continue; // Already processed (else insert has just marked it as visited)
                 }
-                visited.set(currentNode, true); // We set it as visited
-                result.emplace_back(currentNode, currentDist); // Now we store the result
+                result.emplace_back(nodeOf(currentNode), currentDist); // Now we store the result
                 // Then we explore neighbors
-                if (weightedAdjacents.contains(currentNode)) { // If there are neighbors
-                    for (const auto& [neighbor, weight] : weightedAdjacents.getRef(currentNode)) { // We iterate through them
+                if (const auto* edges = weightedAdjacents.find(currentNode)) { // If there are neighbors
+                    for (const auto& [neighbor, weight] : *edges) { // We iterate through them
                         WeightType newDist = currentDist + weight; // Here we calculate the new distance with that neighbor weight
-                        if (!distances.contains(neighbor) || newDist < distances.get(neighbor)) { // If the path is shorter or not calculated yet
-                            distances.set(neighbor, newDist); // We update the shortest distance
+                        auto [distance, inserted] = distances.try_emplace(neighbor, newDist); // One lookup, inserts if not calculated yet
+                        if (inserted || newDist < *distance) { // If the path is shorter or not calculated yet
+                            *distance = newDist; // We update the shortest distance
                             pq.push({newDist, neighbor}); // And we add it to the priority queue for further exploration
                         }
                     }
@@ -257,6 +385,348 @@ class Graph {
             return result;
         }
 
+        // Kahn's algorithm on the forward edges, shared by topologicalSort and the path counting sweeps. order starts with the
+        // nodes of in-degree 0 and is also the queue, degrees[id] is the in-degree of every node that takes part (counting only
+        // the edges that take part) and lists[id] its forward list (nullptr if it has none, or if its edges must not be followed).
+        // The nodes in a cycle, or after one, never reach in-degree 0 and are left out of order
+        void kahnOrder(vector<NodeId>& order, vector<size_t>& degrees, const vector<const NeighborList*>& lists) const {
+            for (size_t head = 0; head < order.size(); head++) {
+                if (const NeighborList* neighbors = lists[order[head]]) {
+                    for (NodeId neighbor : *neighbors) {
+                        if (--degrees[neighbor] == 0) {
+                            order.push_back(neighbor);
+                        }
+                    }
+                }
+            }
+        }
+
+        // The vectors of a sweep, indexed by node id. A caller can keep one for many queries (PathsMemo): at the end of a query
+        // only the entries of the nodes it reached are set back to 0, so a query costs the part of the graph that it reaches and
+        // not the whole graph, and the vectors are only allocated again when the graph grows
+        struct SweepScratch {
+            vector<const NeighborList*> lists; // The forward list of every reached node (nullptr for end)
+            vector<size_t> degrees;
+            vector<char> reached;
+            vector<unsigned long long> paths; // 1 or 4 counts per node, see the sweeps
+            vector<NodeId> reachedNodes;      // The entries to set back to 0
+            vector<NodeId> pending;
+            vector<NodeId> order;
+        };
+
+        // Sets back to 0 the entries of scratch that the last query used (width counts per node in paths)
+        void resetScratch(SweepScratch& scratch, NodeId end, size_t width) const {
+            for (NodeId id : scratch.reachedNodes) {
+                scratch.lists[id] = nullptr;
+                scratch.degrees[id] = 0;
+                scratch.reached[id] = 0;
+                fill_n(scratch.paths.begin() + width * size_t(id), width, 0);
+            }
+            fill_n(scratch.paths.begin() + width * size_t(end), width, 0); // end may not have been reached
+            scratch.reachedNodes.clear();
+            scratch.pending.clear();
+            scratch.order.clear();
+        }
+
+        // The nodes that can be reached from start, in topological order (Kahn's algorithm on that part of the graph), are left
+        // in scratch.order. The edges of end are not followed, the paths stop there (as in the recursive helpers).
+        // scratch.lists[id] keeps the forward list of every reached node, so the sweeps do not search forwardAdjacents again.
+        // It throws if some reached node is in a cycle: the recursive helpers would recurse until the stack overflows.
+        // UPDATE: On a scratch that the caller can reuse (all its entries are 0 between queries), width is the number of counts
+        // per node that the sweep keeps in scratch.paths
+        void reachableOrder(NodeId start, NodeId end, SweepScratch& scratch, size_t width) const {
+            if (scratch.lists.size() < alive.size()) { // The new entries are 0 too
+                scratch.lists.resize(alive.size(), nullptr);
+                scratch.degrees.resize(alive.size(), 0);
+                scratch.reached.resize(alive.size(), 0);
+            }
+            if (scratch.paths.size() < width * alive.size()) {
+                scratch.paths.resize(width * alive.size(), 0);
+            }
+            vector<const NeighborList*>& lists = scratch.lists;
+            vector<size_t>& degrees = scratch.degrees;
+            vector<NodeId>& pending = scratch.pending; // Iterative DFS, the order does not matter here
+            pending.push_back(start);
+            scratch.reached[start] = 1;
+            scratch.reachedNodes.push_back(start);
+            while (!pending.empty()) {
+                NodeId current = pending.back();
+                pending.pop_back();
+                if (current == end || (lists[current] = forwardAdjacents.find(current)) == nullptr) continue;
+                for (NodeId neighbor : *lists[current]) {
+                    degrees[neighbor]++;
+                    if (!scratch.reached[neighbor]) {
+                        scratch.reached[neighbor] = 1;
+                        scratch.reachedNodes.push_back(neighbor);
+                        pending.push_back(neighbor);
+                    }
+                }
+            }
+            vector<NodeId>& order = scratch.order;
+            order.reserve(scratch.reachedNodes.size());
+            if (degrees[start] == 0) order.push_back(start); // Every other reached node has at least the edge we reached it by
+            kahnOrder(order, degrees, lists);
+            if (order.size() != scratch.reachedNodes.size()) {
+                resetScratch(scratch, end, width); // So the caller can still use it
+                throw runtime_error("The graph has a cycle that can be reached from the start node, the paths can not be counted.");
+            }
+        }
+
+        // countPaths once the nodes are ids (shared by the NodeType and the heterogeneous versions). UPDATE: Instead of the
+        // recursive DFS, one sweep over the reached nodes in reverse topological order: when we get to a node all its neighbors
+        // are done, so paths[node] is the sum of theirs. Nothing is recursive (a chain of 10^6 nodes overflowed the stack)
+        // and the memo is a vector indexed by id instead of a HashMap
+        long long countPathsIds(NodeId start, NodeId end) const {
+            SweepScratch scratch;
+            return countPathsIds(start, end, scratch);
+        }
+
+        // The same with the scratch of the caller (the PathsMemo overload of countPaths)
+        long long countPathsIds(NodeId start, NodeId end, SweepScratch& scratch) const {
+            if (!isDirected) {
+                throw runtime_error("Graph must be directed to count paths using this method.");
+            }
+            reachableOrder(start, end, scratch, 1);
+            const vector<NodeId>& order = scratch.order;
+            const vector<const NeighborList*>& lists = scratch.lists;
+            // unsigned so that the counts that do not fit wrap around without undefined behavior (the same values as before)
+            vector<unsigned long long>& paths = scratch.paths;
+            paths[end] = 1;
+            for (size_t i = order.size(); i-- > 0; ) {
+                NodeId current = order[i];
+                if (current == end || lists[current] == nullptr) continue;
+                unsigned long long totalPaths = 0;
+                for (NodeId neighbor : *lists[current]) {
+                    totalPaths += paths[neighbor];
+                }
+                paths[current] = totalPaths;
+            }
+            long long result = static_cast<long long>(paths[start]);
+            resetScratch(scratch, end, 1);
+            HASHMAP_STAT(lastQueryStats = "null"); // No memo table
+            return result;
+        }
+
+        // Same sweep for countPathsThrough2. Each node has 4 counts, one for each pair of flags (node1 visited, node2 visited)
+        // with which a path can arrive to it: paths[4 * id + flags], flags = visited1 | visited2 << 1
+        long long countPathsThrough2Ids(NodeId start, NodeId end, const NodeId* node1, const NodeId* node2) const {
+            if (!isDirected) {
+                throw runtime_error("Graph must be directed to count paths using this method.");
+            }
+            if (node1 == nullptr || node2 == nullptr) {
+                return 0; // No path can visit a node that is not in the graph
+            }
+            SweepScratch scratch;
+            reachableOrder(start, end, scratch, 4);
+            const vector<NodeId>& order = scratch.order;
+            const vector<const NeighborList*>& lists = scratch.lists;
+            vector<unsigned long long>& paths = scratch.paths;
+            paths[4 * size_t(end) + 3] = 1; // Only a path that arrives with both flags counts
+            for (size_t i = order.size(); i-- > 0; ) {
+                NodeId current = order[i];
+                if (current == end || lists[current] == nullptr) continue;
+                unsigned here = (current == *node1) | (current == *node2) << 1; // The flags that this node sets
+                unsigned long long totalPaths[4] = {0, 0, 0, 0}; // Paths that leave this node with each pair of flags
+                for (NodeId neighbor : *lists[current]) {
+                    for (unsigned flags = 0; flags < 4; flags++) {
+                        totalPaths[flags] += paths[4 * size_t(neighbor) + flags];
+                    }
+                }
+                for (unsigned flags = 0; flags < 4; flags++) {
+                    paths[4 * size_t(current) + flags] = totalPaths[flags | here];
+                }
+            }
+            HASHMAP_STAT(lastQueryStats = "null");
+            return static_cast<long long>(paths[4 * size_t(start)]);
+        }
+
+        // Levels with fewer nodes than this are done by the calling thread in countPathsLevels, waking the pool costs more
+        static constexpr size_t kMinParallelLevel = 1024;
+
+        // fn(begin, end, thread) on [0, count), split among the threads of the pool if count is big enough
+        template<typename F>
+        void forChunks(size_t count, ThreadPool& pool, F&& fn) const {
+            if (count < kMinParallelLevel || pool.size() == 1) {
+                fn(0, count, 0);
+            } else {
+                pool.parallelFor(count, fn);
+            }
+        }
+
+        // reachableOrder for several threads, also split in levels. Every step works on a whole frontier at once, split among
+        // the threads, and the threads only meet at the end of the step (parallelFor returns):
+        // 1. A BFS from start finds the reached nodes (the edges of end are not followed). The in-degrees are atomic counters,
+        //    and a node is added to the next frontier by the thread that marks it first. The lists of a frontier are looked up
+        //    by the calling thread before the threads start: a lookup is not a pure read (with -DHASHMAP_STATS it counts the
+        //    hit, and the IncrementalTable moves buckets while it searches), so forwardAdjacents is never used by two threads.
+        // 2. Kahn's algorithm by rounds: the level 0 is start, and the level k + 1 are the nodes whose in-degree got to 0 while
+        //    the level k was processed. Every edge goes to a later level, so all the neighbors of a node are in later levels.
+        // The nodes of the level l are levelNodes[levelStarts[l] .. levelStarts[l + 1]). It throws on a cycle, like reachableOrder
+        void reachableLevels(NodeId start, NodeId end, ThreadPool& pool, vector<const NeighborList*>& lists,
+                             vector<NodeId>& levelNodes, vector<size_t>& levelStarts) const {
+            size_t n = alive.size();
+            lists.assign(n, nullptr);
+            unique_ptr<atomic<size_t>[]> degrees(new atomic<size_t>[n]()); // () sets them to 0
+            unique_ptr<atomic<char>[]> reached(new atomic<char>[n]());
+            vector<vector<NodeId>> found(pool.size()); // The nodes that each thread adds to the next frontier or level
+
+            // Joins the nodes found by all the threads at the end of 'to' (the threads finished, nothing else touches them)
+            auto gather = [&](vector<NodeId>& to) {
+                for (vector<NodeId>& mine : found) {
+                    to.insert(to.end(), mine.begin(), mine.end());
+                    mine.clear();
+                }
+            };
+
+            vector<NodeId> frontier = {start};
+            vector<NodeId> next;
+            reached[start] = 1;
+            size_t reachedCount = 1;
+            while (!frontier.empty()) {
+                for (NodeId current : frontier) {
+                    if (current != end) lists[current] = forwardAdjacents.find(current);
+                }
+                forChunks(frontier.size(), pool, [&](size_t begin, size_t finish, size_t thread) {
+                    for (size_t i = begin; i < finish; i++) {
+                        NodeId current = frontier[i];
+                        if (lists[current] == nullptr) continue; // No list, or it is end
+                        for (NodeId neighbor : *lists[current]) {
+                            degrees[neighbor].fetch_add(1, memory_order_relaxed);
+                            if (!reached[neighbor].exchange(1, memory_order_relaxed)) {
+                                found[thread].push_back(neighbor);
+                            }
+                        }
+                    }
+                });
+                next.clear();
+                gather(next);
+                reachedCount += next.size();
+                frontier.swap(next);
+            }
+
+            levelNodes.clear();
+            levelNodes.reserve(reachedCount); // So levelNodes never moves while the threads read it
+            levelStarts.assign(1, 0);
+            if (degrees[start].load(memory_order_relaxed) == 0) levelNodes.push_back(start); // Else start is in a cycle
+            for (size_t first = 0; first < levelNodes.size(); ) {
+                size_t last = levelNodes.size();
+                levelStarts.push_back(last);
+                forChunks(last - first, pool, [&](size_t begin, size_t finish, size_t thread) {
+                    for (size_t i = first + begin; i < first + finish; i++) {
+                        if (const NeighborList* neighbors = lists[levelNodes[i]]) {
+                            for (NodeId neighbor : *neighbors) {
+                                if (degrees[neighbor].fetch_sub(1, memory_order_relaxed) == 1) { // Its last incoming edge
+                                    found[thread].push_back(neighbor);
+                                }
+                            }
+                        }
+                    }
+                });
+                gather(levelNodes);
+                first = last;
+            }
+            if (levelNodes.size() != reachedCount) {
+                throw runtime_error("The graph has a cycle that can be reached from the start node, the paths can not be counted.");
+            }
+        }
+
+        // countPathsIds with the levels computed in parallel, from the last one to the first one. The nodes of a level only read
+        // the counts of later levels, which are final, and each count is written by one thread, so there are no locks
+        long long countPathsLevelsIds(NodeId start, NodeId end, ThreadPool& pool) const {
+            if (!isDirected) {
+                throw runtime_error("Graph must be directed to count paths using this method.");
+            }
+            vector<const NeighborList*> lists;
+            vector<NodeId> levelNodes;
+            vector<size_t> levelStarts;
+            reachableLevels(start, end, pool, lists, levelNodes, levelStarts);
+            vector<unsigned long long> paths(alive.size(), 0);
+            paths[end] = 1;
+            for (size_t level = levelStarts.size() - 1; level-- > 0; ) {
+                size_t first = levelStarts[level];
+                forChunks(levelStarts[level + 1] - first, pool, [&](size_t begin, size_t finish, size_t) {
+                    for (size_t i = first + begin; i < first + finish; i++) {
+                        NodeId current = levelNodes[i];
+                        if (current == end || lists[current] == nullptr) continue;
+                        unsigned long long totalPaths = 0;
+                        for (NodeId neighbor : *lists[current]) {
+                            totalPaths += paths[neighbor];
+                        }
+                        paths[current] = totalPaths;
+                    }
+                });
+            }
+            HASHMAP_STAT(lastQueryStats = "null");
+            return static_cast<long long>(paths[start]);
+        }
+
+        // Same for countPathsThrough2Ids (4 counts per node)
+        long long countPathsThrough2LevelsIds(NodeId start, NodeId end, const NodeId* node1, const NodeId* node2, ThreadPool& pool) const {
+            if (!isDirected) {
+                throw runtime_error("Graph must be directed to count paths using this method.");
+            }
+            if (node1 == nullptr || node2 == nullptr) {
+                return 0; // No path can visit a node that is not in the graph
+            }
+            vector<const NeighborList*> lists;
+            vector<NodeId> levelNodes;
+            vector<size_t> levelStarts;
+            reachableLevels(start, end, pool, lists, levelNodes, levelStarts);
+            vector<unsigned long long> paths(4 * alive.size(), 0);
+            paths[4 * size_t(end) + 3] = 1;
+            for (size_t level = levelStarts.size() - 1; level-- > 0; ) {
+                size_t first = levelStarts[level];
+                forChunks(levelStarts[level + 1] - first, pool, [&](size_t begin, size_t finish, size_t) {
+                    for (size_t i = first + begin; i < first + finish; i++) {
+                        NodeId current = levelNodes[i];
+                        if (current == end || lists[current] == nullptr) continue;
+                        unsigned here = (current == *node1) | (current == *node2) << 1;
+                        unsigned long long totalPaths[4] = {0, 0, 0, 0};
+                        for (NodeId neighbor : *lists[current]) {
+                            for (unsigned flags = 0; flags < 4; flags++) {
+                                totalPaths[flags] += paths[4 * size_t(neighbor) + flags];
+                            }
+                        }
+                        for (unsigned flags = 0; flags < 4; flags++) {
+                            paths[4 * size_t(current) + flags] = totalPaths[flags | here];
+                        }
+                    }
+                });
+            }
+            HASHMAP_STAT(lastQueryStats = "null");
+            return static_cast<long long>(paths[4 * size_t(start)]);
+        }
+
+        // The recursive DFS with a memo HashMap, kept as the reference for the sweeps above (countPathsRecursive)
+        long long countPathsRecursiveIds(NodeId start, NodeId end) const {
+            if (!isDirected) {
+                throw runtime_error("Graph must be directed to count paths using this method.");
+            }
+            Arena scratch; // UPDATE: The memo of the query lives in an arena, its memory is freed at once when the query ends
+            Map<NodeId, long long> memo(&scratch);
+            memo.reserve(nodeCount); // At most one entry per node, so we allocate once
+            long long paths = countPathsHelper(start, end, memo);
+            HASHMAP_STAT(lastQueryStats = memo.statsJson()); // The memo dies with the query, so we keep its statistics now
+            return paths;
+        }
+
+        // Same for countPathsThrough2Recursive, a required node that is not in the graph is a nullptr
+        long long countPathsThrough2RecursiveIds(NodeId start, NodeId end, const NodeId* node1, const NodeId* node2) const {
+            if (!isDirected) {
+                throw runtime_error("Graph must be directed to count paths using this method.");
+            }
+            if (node1 == nullptr || node2 == nullptr) {
+                return 0; // No path can visit a node that is not in the graph
+            }
+            // State: (current, visited_node1, visited_node2)
+            Arena scratch;
+            Map<tuple<NodeId, bool, bool>, long long, TupleHash3<NodeId, bool, bool>> memo(&scratch); // Custom hash for the tuple explained in README
+            memo.reserve(nodeCount); // At least one state per reached node (it can still grow if a node is reached with other flags)
+            long long paths = countPathsThrough2Helper(start, end, *node1, *node2, false, false, memo);
+            HASHMAP_STAT(lastQueryStats = memo.statsJson());
+            return paths;
+        }
+
     public:
         //========================================================================================================================  
         //                                              Constructor & Destructor
@@ -264,7 +734,13 @@ class Graph {
         // Default constructor, directed, unweighted, no node data
         Graph() {}
         // Custom constructor
-        Graph(bool directed, bool weighted, bool nodeData) : isDirected(directed), isWeighted(weighted), hasNodeData(nodeData) {} 
+        Graph(bool directed, bool weighted, bool nodeData) : isWeighted(weighted), hasNodeData(nodeData), isDirected(directed) {} 
+        // UPDATE: Same but all the maps of the graph (and the interned nodes) take their memory from resource, for example an
+        // Arena when the graph is built once and destroyed at the end. The adjacency vectors still use the heap.
+        // The resource must live longer than the graph
+        Graph(bool directed, bool weighted, bool nodeData, pmr::memory_resource* resource)
+            : names(resource), alive(resource), forwardAdjacents(resource), backwardAdjacents(resource), weightedAdjacents(resource),
+              inDegrees(resource), data(resource), isWeighted(weighted), hasNodeData(nodeData), isDirected(directed) {}
 
         ~Graph() {
             clear();
@@ -276,7 +752,7 @@ class Graph {
 
         // Construction of the graph from edges and nodes (NOT WEIGHTED)
         void addNode(const NodeType& node) {
-            if(!hasNode(node)) allNodes.insert(node);
+            addNodeId(node);
         }
 
 
@@ -285,31 +761,29 @@ class Graph {
             if(!hasNodeData) {
                 throw runtime_error("This graph's nodes do not have associated data.");
             }
-            allNodes.insert(node);
+            NodeId id = addNodeId(node);
             // We aadd it to weightedAdjacents with empty vector
-            data.set(node, nodeData);
+            data.set(id, nodeData);
         }
 
         // Remove node from the graph
         void removeNode(const NodeType& node) {
-            removeNodeFromGraph(node);
+            if (const NodeId* id = findId(node)) {
+                removeNodeFromGraph(*id);
+            }
         }
 
         // Add edge (from, to) to the graph. If you add an edge with nodes that do not exist, they are created without data. Use addNode beforehand if you want data
         // or set it later with setNodeData() method.
         void addEdge(const NodeType& from, const NodeType& to) {
-            if (isWeighted) {
-                throw runtime_error("Graph is weighted, use addNode with weight parameter.");
-            }
-            if (!hasNode(from) || !hasNode(to)) {
-                // We create the nodes without data if they do not exist
-                addNode(from);
-                addNode(to);
-            }
-            addEdgeToGraph(from, to);
-            if (!isDirected) {
-                addEdgeToGraph(to, from); // For undirected graphs, we add the reverse edge
-            }
+            addUnweightedEdge(from, to);
+        }
+
+        // UPDATE: Same for a Graph<string> with std::string_view nodes, so a parser can pass the pieces of the line as they are.
+        // A name that is already in the graph is not copied at all
+        template<typename Node = NodeType, IfTransparent<Node> = 0>
+        void addEdge(string_view from, string_view to) {
+            addUnweightedEdge(from, to);
         }
 
         // Adds a weighted edge to the graph (from, to, weight). If you add an edge with nodes that do not exist, they are created without data. 
@@ -318,26 +792,23 @@ class Graph {
             if (!isWeighted) {
                 throw runtime_error("Graph is unweighted, cannot add weighted edges.");
             }
-            if (!hasNode(from) || !hasNode(to)) {
-                // We create the nodes without data if they do not exist
-                addNode(from);
-                addNode(to);
-            }
-            addEdgeToGraph(from, to, weight);
+            // We create the nodes without data if they do not exist
+            NodeId fromId = addNodeId(from);
+            NodeId toId = addNodeId(to);
+            addEdgeToGraph(fromId, toId, weight);
             if (!isDirected) {
-                addEdgeToGraph(to, from, weight); // For undirected graphs, we add the reverse edge
+                addEdgeToGraph(toId, fromId, weight); // For undirected graphs, we add the reverse edge
             }
         }
 
         // Remove edge (from, to) from the graph
         void removeEdge(const NodeType& from, const NodeType& to) {
-            if (!hasNode(from) || !hasNode(to)) {
+            const NodeId* fromId = findId(from);
+            const NodeId* toId = findId(to);
+            if (fromId == nullptr || toId == nullptr) {
                 throw runtime_error("Both nodes must exist in the graph.");
             }
-            removeFromAdjacencyList(from, to);
-            if (!isDirected) {
-                removeFromAdjacencyList(to, from); // For undirected graphs, we remove the reverse edge
-            }
+            removeEdgeIds(*fromId, *toId);
         }
 
         // Clear function, removes all nodes and edges
@@ -346,39 +817,179 @@ class Graph {
             backwardAdjacents.clear();
             inDegrees.clear();
             weightedAdjacents.clear();
-            allNodes.clear();
             data.clear();
+            names.clear();
+            alive.clear();
+            nodeCount = 0;
         }
 
-        // Count all paths from start node to end node using DFS with memoization (start, end), only for DAGs
+        // Count all paths from start node to end node (start, end), only for DAGs. UPDATE: It is no longer a recursive DFS but a
+        // sweep in reverse topological order (see countPathsIds), and it throws if there is a cycle after start
         long long countPaths(const NodeType& start, const NodeType& end) const {
-            if (!hasNode(start) || !hasNode(end)) {
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) {
+                throw runtime_error("Both nodes must exist in the graph.");
+            }
+            return countPathsIds(*startId, *endId);
+        }
+
+        // The previous countPaths, DFS with memoization. It gives the same results on a DAG and it is kept to check the sweep
+        // (it recurses once per node of the path, so a long chain overflows the stack, and a cycle never ends)
+        long long countPathsRecursive(const NodeType& start, const NodeType& end) const {
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) {
+                throw runtime_error("Both nodes must exist in the graph.");
+            }
+            return countPathsRecursiveIds(*startId, *endId);
+        }
+
+        // UPDATE: Memo that a caller can keep and pass to countPaths for every query. Its engine is the EpochTable, whose clear()
+        // is O(1), so the same table (and its memory) is reused by millions of queries instead of building a memo for each one.
+        // UPDATE 2: Now it is the scratch of the sweep (vectors indexed by id, see SweepScratch), each query only sets back to 0
+        // the nodes it reached, so reusing it is still cheap and the overload does not recurse either
+        using PathsMemo = SweepScratch;
+
+        // Same as countPaths but with the memo of the caller. Example:
+        // Graph<string>::PathsMemo memo; for (...) total += graph.countPaths(from, to, memo);
+        long long countPaths(const NodeType& start, const NodeType& end, PathsMemo& memo) const {
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) {
+                throw runtime_error("Both nodes must exist in the graph.");
+            }
+            return countPathsIds(*startId, *endId, memo);
+        }
+
+        // Same as countPaths but running the DFS on several threads that share a ConcurrentHashMap memo, every subproblem is still
+        // computed only once. The graph must not be modified while it runs. UPDATE: reachableOrder runs first, so a reachable
+        // cycle throws the same runtime_error as countPaths (before, a thread waited forever in get_or_compute for the key it
+        // was computing itself). Its lists are the forward lists of the reached nodes, so the threads never search
+        // forwardAdjacents. If a thread throws, we still join all of them and then rethrow the first exception
+        long long countPathsParallel(const NodeType& start, const NodeType& end, int numThreads) const {
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) {
                 throw runtime_error("Both nodes must exist in the graph.");
             }
             if (!isDirected) {
                 throw runtime_error("Graph must be directed to count paths using this method.");
             }
-            HashMap<NodeType, long long> memo;
-            return countPathsHelper(start, end, memo);
+            SweepScratch scratch;
+            reachableOrder(*startId, *endId, scratch, 0); // Throws on a cycle, we do not need the counts
+            const vector<const NeighborList*>& lists = scratch.lists;
+            ConcurrentHashMap<NodeId, long long, DefaultHash<NodeId>, Storage> memo;
+            memo.reserve(nodeCount);
+            vector<long long> results(max(numThreads, 1));
+            exception_ptr failure; // First exception of any thread
+            mutex failureLock;
+            auto run = [&](int t) {
+                try {
+                    results[t] = countPathsParallelHelper(*startId, *endId, lists, memo, t);
+                } catch (...) {
+                    lock_guard<mutex> guard(failureLock);
+                    if (!failure) failure = current_exception();
+                }
+            };
+            vector<thread> workers;
+            try {
+                for (int t = 1; t < numThreads; t++) { // The calling thread is the thread 0
+                    workers.emplace_back(run, t);
+                }
+            } catch (...) { // Could not start a thread, the ones that started still have to be joined
+                lock_guard<mutex> guard(failureLock);
+                if (!failure) failure = current_exception();
+            }
+            if (!failure) {
+                run(0);
+            }
+            for (thread& worker : workers) {
+                worker.join();
+            }
+            if (failure) {
+                rethrow_exception(failure);
+            }
+            return results[0]; // Every thread gets the same result
         }
 
-        // Count paths from start to end that visit both node1 AND node2 using DFS with memoization (start, end, node1, node2)
+        // Count paths from start to end that visit both node1 AND node2 (start, end, node1, node2). UPDATE: Also a sweep in
+        // reverse topological order now, with 4 counts per node instead of the (node, visited1, visited2) memo
         long long countPathsThrough2(const NodeType& start, const NodeType& end, 
                                      const NodeType& node1, const NodeType& node2) const {
-            if (!hasNode(start) || !hasNode(end)) {
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) {
                 throw runtime_error("Both nodes must exist in the graph.");
             }
-            if (!isDirected) {
-                throw runtime_error("Graph must be directed to count paths using this method.");
+            return countPathsThrough2Ids(*startId, *endId, findId(node1), findId(node2));
+        }
+
+        // The previous countPathsThrough2 (DFS with memoization), kept as the reference
+        long long countPathsThrough2Recursive(const NodeType& start, const NodeType& end,
+                                              const NodeType& node1, const NodeType& node2) const {
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) {
+                throw runtime_error("Both nodes must exist in the graph.");
             }
-            // State: (current, visited_node1, visited_node2)
-            HashMap<tuple<NodeType, bool, bool>, long long, TupleHash3<NodeType, bool, bool>> memo; // Custom hash for the tuple explained in README
-            return countPathsThrough2Helper(start, end, node1, node2, false, false, memo);
+            return countPathsThrough2RecursiveIds(*startId, *endId, findId(node1), findId(node2));
+        }
+
+        // UPDATE: Level synchronous versions of the sweeps for several cores. The reached nodes are split in levels by Kahn's
+        // algorithm (the nodes of a level only depend on later levels) and every level is split among the threads of the
+        // pool, with a wait for all of them between two levels. The search of the reached nodes and the levels themselves are
+        // computed the same way (see reachableLevels). The pool (ThreadPool.h) can be kept for many queries. Example:
+        // ThreadPool pool(8); graph.countPathsLevels(from, to, pool);
+        // The graph must not be modified while it runs
+        long long countPathsLevels(const NodeType& start, const NodeType& end, ThreadPool& pool) const {
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) {
+                throw runtime_error("Both nodes must exist in the graph.");
+            }
+            return countPathsLevelsIds(*startId, *endId, pool);
+        }
+
+        long long countPathsThrough2Levels(const NodeType& start, const NodeType& end,
+                                           const NodeType& node1, const NodeType& node2, ThreadPool& pool) const {
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) {
+                throw runtime_error("Both nodes must exist in the graph.");
+            }
+            return countPathsThrough2LevelsIds(*startId, *endId, findId(node1), findId(node2), pool);
+        }
+
+        // UPDATE: countPaths and countPathsThrough2 also accept std::string_view or const char* (for a Graph<string>), for example
+        // graph.countPaths("you", "out") does not build any std::string: the interner finds the ids of the names directly
+        template<typename Q1, typename Q2, typename Node = NodeType, IfTransparent<Node> = 0>
+        long long countPaths(const Q1& start, const Q2& end) const {
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) {
+                throw runtime_error("Both nodes must exist in the graph.");
+            }
+            return countPathsIds(*startId, *endId);
+        }
+
+        template<typename Q1, typename Q2, typename Q3, typename Q4, typename Node = NodeType, IfTransparent<Node> = 0>
+        long long countPathsThrough2(const Q1& start, const Q2& end, const Q3& node1, const Q4& node2) const {
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) {
+                throw runtime_error("Both nodes must exist in the graph.");
+            }
+            return countPathsThrough2Ids(*startId, *endId, findId(node1), findId(node2));
         }
 
         // Common BFS implementation for shortest path (not used in AoC11)
         vector<NodeType> bfsShortestPath(const NodeType& start, const NodeType& end) const {
-            return bfsShortestPathHelper(start, end);
+            if (start == end) return {start}; // Trivial case, even for a node that is not in the graph (like before)
+            const NodeId* startId = findId(start);
+            const NodeId* endId = findId(end);
+            if (startId == nullptr || endId == nullptr) return {}; // There is no path to or from a node that is not in the graph
+            return bfsShortestPathHelper(*startId, *endId);
         }
 
         // Dijkstra's algorithm for shortest paths from start node (not used in AoC11)
@@ -387,56 +998,67 @@ class Graph {
             if (!isWeighted) {
                 throw runtime_error("Graph is not weighted, cannot perform Dijkstra's algorithm.");
             }
-            if (!hasNode(start)) throw runtime_error("Start node must exist in the graph.");
-            return dijkstraHelper(start);
+            const NodeId* startId = findId(start);
+            if (startId == nullptr) throw runtime_error("Start node must exist in the graph.");
+            return dijkstraHelper(*startId);
         }
 
         //========================================================================================================================
         //                                                  Getters
         //========================================================================================================================
 
-        // Checks if a node exists in the graph
+        // Checks if a node exists in the graph (UPDATE: one lookup in the interner, before it was an O(log n) search in a std::set)
         bool hasNode(const NodeType& node) const {
-            return allNodes.find(node) != allNodes.end();
+            return findId(node) != nullptr;
+        }
+
+        template<typename Q, typename Node = NodeType, IfTransparent<Node> = 0>
+        bool hasNode(const Q& node) const { // Heterogeneous version, e.g. graph.hasNode(string_view(line).substr(0, 3))
+            return findId(node) != nullptr;
         }
+
         // Get the forward neighbors of a node
         vector<NodeType> getForwardNeighbors(const NodeType& node) const {
-            if (forwardAdjacents.contains(node)) {
-                return forwardAdjacents.get(node);
-            }
-            return vector<NodeType>(); // Return empty vector if no neighbors
+            const NodeId* id = findId(node);
+            return nodesOf(id ? forwardAdjacents.find(*id) : nullptr); // Empty vector if no neighbors
+        }
+
+        template<typename Q, typename Node = NodeType, IfTransparent<Node> = 0>
+        vector<NodeType> getForwardNeighbors(const Q& node) const {
+            const NodeId* id = findId(node);
+            return nodesOf(id ? forwardAdjacents.find(*id) : nullptr);
         }
 
         // Get the backward neighbors of a node
         vector<NodeType> getBackwardNeighbors(const NodeType& node) const {
-            if (backwardAdjacents.contains(node)) {
-                return backwardAdjacents.get(node);
-            }
-            return vector<NodeType>(); // Return empty vector if no neighbors
+            const NodeId* id = findId(node);
+            return nodesOf(id ? backwardAdjacents.find(*id) : nullptr); // Empty vector if no neighbors
         }
 
         // Get in-degree of a node
-        int getInDegree(const NodeType& node) const {
-            if (!hasNode(node)) {
+        size_t getInDegree(const NodeType& node) const {
+            const NodeId* id = findId(node);
+            if (id == nullptr) {
                 throw runtime_error("Node does not exist in the graph.");
             }
-            if (inDegrees.contains(node)) {
-                return inDegrees.get(node);
-            }
-            return 0; // If node has no incoming edges
+            const size_t* degree = inDegrees.find(*id);
+            return degree ? *degree : 0; // If node has no incoming edges it is 0
         }
 
         // Get the size of the graph (number of unique nodes)
         size_t size() const {
-            return allNodes.size();
+            return nodeCount;
         }
 
-        // Get all nodes in the graph with no dependencies (leaf nodes)
+        // Get all nodes in the graph with no dependencies (leaf nodes). UPDATE: The lists of nodes are now in the order in
+        // which the nodes were added (the order of their ids), before they were sorted (the order of the std::set)
         vector<NodeType> getLeafNodes() const {
             vector<NodeType> leaves;
-            for (const NodeType& node : allNodes) {
-                if (getForwardNeighbors(node).empty()) {
-                    leaves.push_back(node);
+            for (NodeId id = 0; id < alive.size(); id++) {
+                if (!alive[id]) continue;
+                const NeighborList* neighbors = forwardAdjacents.find(id);
+                if (neighbors == nullptr || neighbors->empty()) {
+                    leaves.push_back(nodeOf(id));
                 }
             }
             return leaves;
@@ -445,9 +1067,11 @@ class Graph {
         // Get all nodes in the graph with no incoming edges (in-degree 0)
         vector<NodeType> getRootNodes() const {
             vector<NodeType> roots;
-            for (const NodeType& node : allNodes) {
-                if (getInDegree(node) == 0) {
-                    roots.push_back(node);
+            for (NodeId id = 0; id < alive.size(); id++) {
+                if (!alive[id]) continue;
+                const size_t* degree = inDegrees.find(id);
+                if (degree == nullptr || *degree == 0) {
+                    roots.push_back(nodeOf(id));
                 }
             }
             return roots;
@@ -456,32 +1080,35 @@ class Graph {
         // Get all nodes in the graph
         vector<NodeType> getAllNodes() const {
             vector<NodeType> nodes;
-            for (const NodeType& node : allNodes) {
-                nodes.push_back(node);
+            nodes.reserve(nodeCount);
+            for (NodeId id = 0; id < alive.size(); id++) {
+                if (alive[id]) nodes.push_back(nodeOf(id));
             }
             return nodes;
         }
 
         // Check if an edge exists in the forward direction
         bool hasEdgeForward(const NodeType& from, const NodeType& to) const {
-            if(!hasNode(from) || !hasNode(to)) {
+            const NodeId* fromId = findId(from);
+            const NodeId* toId = findId(to);
+            if (fromId == nullptr || toId == nullptr) {
                 throw runtime_error("Both nodes must exist in the graph.");
             }
-            if (forwardAdjacents.contains(from)) {
-                vector<NodeType> neighbors = forwardAdjacents.get(from);
-                return find(neighbors.begin(), neighbors.end(), to) != neighbors.end();
+            if (const NeighborList* neighbors = forwardAdjacents.find(*fromId)) { // No copy of the vector anymore
+                return std::find(neighbors->begin(), neighbors->end(), *toId) != neighbors->end();
             }
             return false;
         }
 
         // Check if an edge exists in the backward direction
         bool hasEdgeBackward(const NodeType& to, const NodeType& from) const {
-            if (!hasNode(from) || !hasNode(to)) {
+            const NodeId* fromId = findId(from);
+            const NodeId* toId = findId(to);
+            if (fromId == nullptr || toId == nullptr) {
                 throw runtime_error("Both nodes must exist in the graph.");
             }
-            if (backwardAdjacents.contains(to)) {
-                vector<NodeType> neighbors = backwardAdjacents.get(to);
-                return find(neighbors.begin(), neighbors.end(), from) != neighbors.end();
+            if (const NeighborList* neighbors = backwardAdjacents.find(*toId)) {
+                return std::find(neighbors->begin(), neighbors->end(), *fromId) != neighbors->end();
             }
             return false;
         }
@@ -495,14 +1122,13 @@ class Graph {
         }
 
         // Get the number of neighbors of a node (outgoing edges)
-        int getOutDegree(const NodeType& node) const {
-            if (!hasNode(node)) {
+        size_t getOutDegree(const NodeType& node) const {
+            const NodeId* id = findId(node);
+            if (id == nullptr) {
                 throw runtime_error("Node does not exist in the graph.");
             }
-            if (forwardAdjacents.contains(node)) {
-                return forwardAdjacents.getRef(node).size();
-            }
-            return 0;
+            const NeighborList* neighbors = forwardAdjacents.find(*id);
+            return neighbors ? neighbors->size() : 0;
         }
 
         // Get node data
@@ -510,33 +1136,92 @@ class Graph {
             if (!hasNodeData) {
                 throw runtime_error("This graph's nodes do not have associated data.");
             }
-            if (!hasNode(node)) {
+            const NodeId* id = findId(node);
+            if (id == nullptr) {
                 throw runtime_error("Node does not exist in the graph.");
             }
-            return data.get(node);
+            return data.get(*id);
         }
 
         // Get the total of Nodes in the graph
-        int getTotalNodes() const {
-            return allNodes.size();
+        size_t getTotalNodes() const {
+            return nodeCount;
         }
 
         // Get weight of an edge (from, to)
         WeightType getWeight(const NodeType& from, const NodeType& to) const {
             if (!isWeighted) throw runtime_error("Graph is not weighted, cannot get weights.");
-            if (!hasNode(from) || !hasNode(to)) {
+            const NodeId* fromId = findId(from);
+            const NodeId* toId = findId(to);
+            if (fromId == nullptr || toId == nullptr) {
                 throw runtime_error("Both nodes must exist in the graph.");
             }
-            if (!weightedAdjacents.contains(from)) throw runtime_error("Edge does not exist to get weight.");
-            const auto& edges = weightedAdjacents.getRef(from);
-            for (const auto& e : edges) {
-                if (e.first == to) {
+            const WeightedList* edges = weightedAdjacents.find(*fromId);
+            if (edges == nullptr) throw runtime_error("Edge does not exist to get weight.");
+            for (const auto& e : *edges) {
+                if (e.first == *toId) {
                     return e.second;
                 }
             }
             throw runtime_error("Edge does not exist to get weight.");
         }
 
+        // UPDATE: Read-only copy of the graph for queries: dense ids and the edges in arrays (compressed sparse row), so the
+        // traversals do not hash anything (see CsrGraph.h, it has to be included to call it). Example:
+        // CsrGraph<string> frozen = graph.freeze(); frozen.countPaths("you", "out");
+        CsrGraph<NodeType, WeightType> freeze() const {
+            using CsrId = typename CsrGraph<NodeType, WeightType>::NodeId;
+            // The ids of the graph are already dense, only the removed nodes leave holes. The CsrGraph ids are the same ones
+            // without the holes, so they also follow the order in which the nodes were added
+            // UPDATE: The id map of the CsrGraph is a NodeInterner too (before it was a FrozenHashMap, whose perfect hash took
+            // most of the time of freeze()). Interning the nodes in the order of the ids gives every node its CsrGraph id
+            vector<CsrId> compact(alive.size(), CsrGraph<NodeType, WeightType>::kNoNode);
+            vector<NodeType> nodes;
+            nodes.reserve(nodeCount);
+            auto index = make_shared<typename CsrGraph<NodeType, WeightType>::IdMap>();
+            index->reserve(nodeCount);
+            for (NodeId id = 0; id < alive.size(); id++) {
+                if (!alive[id]) continue;
+                compact[id] = static_cast<CsrId>(nodes.size());
+                nodes.push_back(nodeOf(id));
+                index->intern(nodes.back());
+            }
+            // The edges of every node, in the same order as its list. A weighted graph takes them from weightedAdjacents,
+            // which has the same edges as forwardAdjacents with their weights
+            vector<size_t> offsets(nodes.size() + 1, 0);
+            vector<CsrId> targets;
+            vector<WeightType> weights;
+            for (NodeId id = 0; id < alive.size(); id++) {
+                if (!alive[id]) continue;
+                if (isWeighted) {
+                    if (const WeightedList* edges = weightedAdjacents.find(id)) {
+                        for (const auto& [to, weight] : *edges) {
+                            targets.push_back(compact[to]);
+                            weights.push_back(weight);
+                        }
+                    }
+                } else if (const NeighborList* neighbors = forwardAdjacents.find(id)) {
+                    for (NodeId to : *neighbors) {
+                        targets.push_back(compact[to]);
+                    }
+                }
+                offsets[compact[id] + 1] = targets.size();
+            }
+            return CsrGraph<NodeType, WeightType>(std::move(nodes), std::move(index), std::move(offsets), std::move(targets),
+                                                  std::move(weights), isDirected, isWeighted);
+        }
+
+#ifdef HASHMAP_STATS
+        // UPDATE: Statistics of every map of the graph as one JSON object (only with -DHASHMAP_STATS, see HashMap.h).
+        // "lastQuery" is the memo of the last recursive countPaths or countPathsThrough2, null if there was none (the sweeps have no memo)
+        string statsJson() const {
+            return "{\"names\": " + names.statsJson() + ", \"forwardAdjacents\": " + forwardAdjacents.statsJson()
+                + ", \"backwardAdjacents\": " + backwardAdjacents.statsJson()
+                + ", \"weightedAdjacents\": " + weightedAdjacents.statsJson() + ", \"inDegrees\": " + inDegrees.statsJson()
+                + ", \"data\": " + data.statsJson() + ", \"lastQuery\": " + lastQueryStats + "}";
+        }
+#endif
+
         //========================================================================================================================
         //                                                 Setters
         //========================================================================================================================
@@ -546,86 +1231,76 @@ class Graph {
             if (!hasNodeData) {
                 throw runtime_error("This graph's nodes do not have associated data.");
             }
-            if (!hasNode(node)) {
+            const NodeId* id = findId(node);
+            if (id == nullptr) {
                 throw runtime_error("Node does not exist in the graph.");
             }
-            data.set(node, nodeData);
+            data.set(*id, nodeData);
         }
 
         // Set weight of an edge (from, to)
         void setWeight(const NodeType& from, const NodeType& to, const WeightType& weight) {
             if (!isWeighted) throw runtime_error("Graph is not weighted, cannot set weights.");
-            if (!hasNode(from) || !hasNode(to)) {
+            const NodeId* fromId = findId(from);
+            const NodeId* toId = findId(to);
+            if (fromId == nullptr || toId == nullptr) {
                 throw runtime_error("Both nodes must exist in the graph.");
             }
-            // update forward weighted edge
-            if (!weightedAdjacents.contains(from)) throw runtime_error("Edge does not exist to set weight.");
-            auto edges = weightedAdjacents.get(from);
+            // update forward weighted edge (UPDATE: in place through find(), before the list was copied and set back)
+            WeightedList* edges = weightedAdjacents.find(*fromId);
+            if (edges == nullptr) throw runtime_error("Edge does not exist to set weight.");
             bool found = false;
-            for (auto& e : edges) {
-                if (e.first == to) { 
+            for (auto& e : *edges) {
+                if (e.first == *toId) { 
                     e.second = weight; 
                     found = true; 
                     break; 
                 }
             }
             if (!found) throw runtime_error("Edge does not exist to set weight.");
-            // we set back the modified edge weights
-            weightedAdjacents.set(from, std::move(edges));
 
             // if undirected, we update reverse weighted edge
             if (!isDirected) {
-                auto reverse = weightedAdjacents.get(to);
-                bool foundRev = false;
-                for (auto& e : reverse) {
-                    if (e.first == from) { 
-                        e.second = weight; 
-                        foundRev = true; 
-                        break; 
+                weightedAdjacents.upsert(*toId, [&](WeightedList& reverse) {
+                    for (auto& e : reverse) {
+                        if (e.first == *fromId) { 
+                            e.second = weight; 
+                            return; 
+                        }
                     }
-                }
-                if (!foundRev) reverse.emplace_back(from, weight);
-                weightedAdjacents.set(to, move(reverse));
+                    reverse.emplace_back(*fromId, weight);
+                });
             }
         }
 
         // EXTRA
 
         // Topological sort for AoC11_P1 as we misunderstood the challenge, we ended not using it but is fully implemented, explained in the README
+        // UPDATE: It walked the backward lists, so it decreased the in-degrees of the nodes before each node instead of the ones
+        // after it, and it only returned the roots. Now it is Kahn's algorithm on the forward lists (kahnOrder, the same that
+        // orders the countPaths sweeps). The nodes in a cycle, or after one, are not in the result
         vector<NodeType> topologicalSort() const {
-            // Copy in-degrees for all nodes, handling nodes with no incoming edges
-            HashMap<NodeType, int> Degrees;
-            for (const auto& node : allNodes) {
-                int degree = inDegrees.contains(node) ? inDegrees.get(node) : 0;
-                Degrees.set(node, degree);
-            }
-
-            // Now we implement a queue for processing nodes with in-degree 0
-            queue<NodeType> processingQueue;
-            for(const auto& node : allNodes) { // We use auto in order to let the compiler decide the best type
-                if (Degrees.get(node) == 0) {
-                    processingQueue.push(node);
+            // Copy in-degrees for all nodes (dense vectors indexed by id), handling nodes with no incoming edges
+            vector<size_t> degrees(alive.size(), 0);
+            vector<const NeighborList*> lists(alive.size(), nullptr);
+            vector<NodeId> order; // Starts with the nodes with in-degree 0
+            order.reserve(nodeCount);
+            for (NodeId node = 0; node < alive.size(); node++) {
+                if (!alive[node]) continue;
+                const size_t* degree = inDegrees.find(node);
+                degrees[node] = degree ? *degree : 0;
+                lists[node] = forwardAdjacents.find(node);
+                if (degrees[node] == 0) {
+                    order.push_back(node);
                 }
             }
+            kahnOrder(order, degrees, lists);
 
             // Now we create a vector where we will store the result
             vector<NodeType> sortedOrder;
-            while (!processingQueue.empty()) {
-                NodeType toCheck = processingQueue.front(); // We get the front node
-                processingQueue.pop(); // We remove it from the queue
-                sortedOrder.push_back(toCheck); // We add it to the sorted order
-
-                // Now we process the dependents of toCheck (nodes that depend on this one)
-                // We use backward adjacents because we need to update nodes that depend on toCheck
-                if (backwardAdjacents.contains(toCheck)) {
-                    for (const NodeType& dependent : backwardAdjacents.getRef(toCheck)) {
-                        int currentDegree = Degrees.get(dependent);
-                        Degrees.set(dependent, currentDegree - 1); // Decrease in-degree
-                        if (Degrees.get(dependent) == 0) {
-                            processingQueue.push(dependent); // If in-degree is 0, add to queue
-                        }
-                    }
-                }
+            sortedOrder.reserve(order.size());
+            for (NodeId node : order) {
+                sortedOrder.push_back(nodeOf(node));
             }
             return sortedOrder;
         }
@@ -9,96 +9,456 @@
 
 #include <vector>
 #include <list>
-#include <utility>
+#include <utility> // std::pair, std::in_place
 #include <stdexcept>
 #include <tuple>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <memory_resource> // std::pmr::memory_resource, see Allocators.h
+#if defined(__SSE2__)
+#include <immintrin.h> // SSE2 and AVX2 intrinsics for the group probing of the FlatTable
+#endif
 
-// Default hash function for single keys, we use modulo of the key value
+// UPDATE: Every hash functor now has two call operators. The one with only the key returns the full hash value (before the modulo),
+// the FlatTable needs it because it takes a 1-byte fingerprint from the high bits. The one with hashSize gives the bucket as before.
+
+// UPDATE 2: The tables now pick the bucket with a growth policy (see below) and the default one uses a power of two size and a
+// mask instead of the modulo. A mask only looks at the low bits of the hash, so keys like row * cols + col or (row, col) would
+// end in a few buckets. That is why the full hash now goes through a finalizer (mix64) that spreads every input bit over all
+// the output bits.
+
+// UPDATE 3: Every size, bucket count and slot index is now a size_t (it was an int). With int the bucket count overflowed
+// at 2^31 (the doubling of PrimeGrowth got there after about 16 resizes from 25013), so a table could never hold more than
+// about 8 * 10^8 entries (2^30 buckets) and the index math was undefined before that. The FlatTable marks "no slot" with kNoSlot.
+
+// 64-bit finalizer of MurmurHash3 (fmix64), it is a bijection so two different keys never get the same mixed value
+inline unsigned long long mix64(unsigned long long x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Combines the hash of one more field into the hash of a pair or a tuple (the order of the fields matters)
+inline unsigned long long hashCombine(unsigned long long seed, unsigned long long value) {
+    return mix64(seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2)));
+}
+
+// Default hash function for single keys, now the key value goes through the mixer
 template<typename K>
 struct DefaultHash {
-    int operator()(const K& key, int hashSize) const {
-        return static_cast<unsigned long long>(key) % hashSize;
+    unsigned long long operator()(const K& key) const {
+        return mix64(static_cast<unsigned long long>(key));
+    }
+    size_t operator()(const K& key, size_t hashSize) const {
+        return (*this)(key) % hashSize;
     }
 };
 
 // Specialization for string hashing (Day 11 of AoC 2025)
+// UPDATE: It is transparent, it also hashes std::string_view and const char* (with the same result as the std::string), so a
+// HashMap<std::string, ...> can be probed without building a temporary std::string (see Heterogeneous lookup below)
 template<> // Allows us to specialize the template of DefaultHash for strings
 struct DefaultHash<std::string> {
-    int operator()(const std::string& key, int hashSize) const {
-        unsigned long long hash = 0;
-        const unsigned long long prime = 31;
+    using is_transparent = void;
+
+    // UPDATE: It was hash * 31 + c, which collides for very short strings ("Aa" and "BB" both give 2112) and the mixer can
+    // not separate two equal inputs. Now it is FNV-1a: every character is xored into the 64-bit state and the state is
+    // multiplied by the FNV prime, so the character changes all the bits above it before the next one comes in
+    unsigned long long operator()(std::string_view key) const {
+        unsigned long long hash = 0xcbf29ce484222325ULL; // FNV offset basis
+        const unsigned long long prime = 0x100000001b3ULL; // FNV prime
         for (char c : key) {
-            hash = hash * prime + static_cast<unsigned long long>(c); // Used a prime multiplier to reduce collisions
-                                                                    // And used casting to unsigned long long to avoid overflow
+            hash = (hash ^ static_cast<unsigned char>(c)) * prime;
         }
-        return hash % hashSize;
+        return mix64(hash); // The multiplication only moves bits up, the mixer spreads them over the low bits too
+    }
+    unsigned long long operator()(const std::string& key) const {
+        return (*this)(std::string_view(key));
+    }
+    unsigned long long operator()(const char* key) const { // Without it a string literal would be ambiguous (string or string_view)
+        return (*this)(std::string_view(key));
+    }
+    size_t operator()(const std::string& key, size_t hashSize) const {
+        return (*this)(key) % hashSize;
+    }
+};
+
+// UPDATE: Same hash for std::string_view keys, used by the names that the Graph interns (see NodeInterner.h). The characters
+// live somewhere else and the map only keeps the view, so the hash is the one of the std::string with the same characters
+template<>
+struct DefaultHash<std::string_view> : DefaultHash<std::string> {
+    using DefaultHash<std::string>::operator();
+    size_t operator()(std::string_view key, size_t hashSize) const {
+        return (*this)(key) % hashSize;
     }
 };
 
-// Hash for pair<A, B>, now we use a multiplication by a prime number to reduce collisions (Day 7 of AoC 2025)
+// Hash for pair<A, B>, before we used first * 31 + second, which collides a lot for (row, col) keys when there are more than 31 columns
 template<typename A, typename B>
 struct PairHash {
-    int operator()(const std::pair<A, B>& key, int hashSize) const {
-        return (static_cast<unsigned long long>(key.first) * 31 + 
-                static_cast<unsigned long long>(key.second)) % hashSize;
+    unsigned long long operator()(const std::pair<A, B>& key) const {
+        return hashCombine(mix64(static_cast<unsigned long long>(key.first)), static_cast<unsigned long long>(key.second));
+    }
+    size_t operator()(const std::pair<A, B>& key, size_t hashSize) const {
+        return (*this)(key) % hashSize;
     }
 };
 
 // Hash for tuple<A, B, C> , now we use the same method but for 3D coordinates (Day 8 of AoC 2025)
 template<typename A, typename B, typename C>
 struct TupleHash3 {
-    int operator()(const std::tuple<A, B, C>& key, int hashSize) const {
-        return ((static_cast<unsigned long long>(std::get<0>(key)) * 31 + 
-                 static_cast<unsigned long long>(std::get<1>(key))) * 31 + 
-                 static_cast<unsigned long long>(std::get<2>(key))) % hashSize;
+    unsigned long long operator()(const std::tuple<A, B, C>& key) const {
+        unsigned long long hash = mix64(static_cast<unsigned long long>(std::get<0>(key)));
+        hash = hashCombine(hash, static_cast<unsigned long long>(std::get<1>(key)));
+        return hashCombine(hash, static_cast<unsigned long long>(std::get<2>(key)));
+    }
+    size_t operator()(const std::tuple<A, B, C>& key, size_t hashSize) const {
+        return (*this)(key) % hashSize;
     }
 };
 
 // Specialization for tuple<string, bool, bool> (for path tracking in AoC11_P2) (AI improved)
 template<>
 struct TupleHash3<std::string, bool, bool> {
-    int operator()(const std::tuple<std::string, bool, bool>& key, int hashSize) const {
+    unsigned long long operator()(const std::tuple<std::string, bool, bool>& key) const {
         // Hash the string first
-        unsigned long long hash = 0;
-        const unsigned long long prime = 31;
-        const std::string& str = std::get<0>(key);
-        for (char c : str) {
-            hash = hash * prime + static_cast<unsigned long long>(c);
+        unsigned long long hash = DefaultHash<std::string>()(std::get<0>(key));
+        // Combine with boolean flags, both in one step as they are only two bits
+        return hashCombine(hash, (std::get<1>(key) ? 1 : 0) | (std::get<2>(key) ? 2 : 0));
+    }
+    size_t operator()(const std::tuple<std::string, bool, bool>& key, size_t hashSize) const {
+        return (*this)(key) % hashSize;
+    }
+};
+
+// Heterogeneous lookup: a hash functor that declares is_transparent accepts other types than the key (like std::string_view
+// for std::string keys). Then find, contains, get and getRef accept any type that the hash takes and that can be compared
+// with the key using ==, and they do not need to build a K for the lookup
+template<typename Hash, typename = void>
+struct IsTransparent : std::false_type {};
+
+template<typename Hash>
+struct IsTransparent<Hash, std::void_t<typename Hash::is_transparent>> : std::true_type {};
+
+//========================================================================================================================
+//                                                  Growth policies
+//========================================================================================================================
+// A growth policy decides the number of buckets of a table and how a full hash value is turned into a bucket index.
+// It is the last template parameter of HashMap, so both can be compared: HashMap<int, int, DefaultHash<int>, FlatTable, PrimeGrowth>
+
+// Power of two sizes (default): the bucket is hash & (size - 1), one AND instead of a 64-bit division on every access
+struct PowerOfTwoGrowth {
+    static const size_t initialSize = 16; // Size of the first allocation of a map that was created empty
+
+    // Smallest power of two that is greater or equal to the requested size
+    static size_t bucketCount(size_t requested) {
+        size_t size = 2;
+        while (size < requested) size *= 2;
+        return size;
+    }
+
+    static size_t grow(size_t current) {
+        return current * 2;
+    }
+
+    static size_t index(unsigned long long hash, size_t size) {
+        return static_cast<size_t>(hash & (size - 1));
+    }
+};
+
+// Prime sizes, the policy we used originally (25013 buckets and modulo). Before, the resize just doubled the size so after
+// the first resize the size was not prime anymore, now we grow to the next prime after the double
+struct PrimeGrowth {
+    static const size_t initialSize = 17;
+
+    static bool isPrime(size_t n) {
+        if (n < 2) return false;
+        for (size_t d = 2; d * d <= n; d++) {
+            if (n % d == 0) return false;
         }
-        // Combine with boolean flags
-        hash = hash * 31 + (std::get<1>(key) ? 1 : 0);
-        hash = hash * 31 + (std::get<2>(key) ? 1 : 0);
-        return hash % hashSize;
+        return true;
+    }
+
+    static size_t bucketCount(size_t requested) {
+        size_t size = requested < 2 ? 2 : requested;
+        while (!isPrime(size)) size++;
+        return size;
+    }
+
+    static size_t grow(size_t current) {
+        return bucketCount(current * 2);
+    }
+
+    static size_t index(unsigned long long hash, size_t size) {
+        return static_cast<size_t>(hash % size);
     }
 };
 
-template<typename K, typename T, typename Hash = DefaultHash<K>> 
-class HashMap {
+// UPDATE: Number of buckets that the policy needs to keep 'elements' keys below the load factor (used by reserve and shrink_to_fit)
+template<typename Growth>
+size_t bucketsFor(size_t elements, double loadFactor) {
+    if (elements == 0) return 0;
+    return Growth::bucketCount(static_cast<size_t>(elements / loadFactor) + 1);
+}
+
+//========================================================================================================================
+//                                              Control byte group probing
+//========================================================================================================================
+// The FlatTable keeps one control byte per slot next to the slots array: 0x80 means empty and a value from 0 to 127 is a
+// 7-bit fingerprint of the hash of the key stored there. Instead of comparing keys one by one, we load a whole group of
+// control bytes and compare all of them with the fingerprint we are looking for in one instruction (16 bytes with SSE2,
+// 32 with AVX2). Only the slots whose fingerprint matches need a real key comparison, which is a big win for string keys.
+
+static const unsigned char kEmptyCtrl = 0x80;
+static const int kMaxGroupWidth = 32; // Widest group we load, the control array has this many extra mirrored bytes at the end
+
+enum class GroupProbe { Scalar, SSE2, AVX2 };
+
+// Result of matching one group: bit i is set if byte i of the group matches the fingerprint / is empty
+struct GroupMatch {
+    unsigned int match;
+    unsigned int empty;
+};
+
+inline GroupMatch matchGroupScalar(const unsigned char* ctrl, unsigned char fingerprint, int width) {
+    GroupMatch result = {0, 0};
+    for (int i = 0; i < width; i++) {
+        result.match |= static_cast<unsigned int>(ctrl[i] == fingerprint) << i;
+        result.empty |= static_cast<unsigned int>(ctrl[i] == kEmptyCtrl) << i;
+    }
+    return result;
+}
+
+#if defined(__SSE2__)
+inline GroupMatch matchGroupSSE2(const unsigned char* ctrl, unsigned char fingerprint) {
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    GroupMatch result;
+    result.match = _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(fingerprint))));
+    result.empty = _mm_movemask_epi8(group); // Only the empty byte (0x80) has the high bit set
+    return result;
+}
+
+// This function is compiled for AVX2 even if the rest of the program is not, we only call it after checking the CPU supports it
+__attribute__((target("avx2"))) inline GroupMatch matchGroupAVX2(const unsigned char* ctrl, unsigned char fingerprint) {
+    __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ctrl));
+    GroupMatch result;
+    result.match = _mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_set1_epi8(static_cast<char>(fingerprint))));
+    result.empty = _mm256_movemask_epi8(group);
+    return result;
+}
+#endif
+
+// Runtime CPU dispatch: we check once which instructions the CPU has and keep the best one.
+// It returns a reference so a benchmark can force another mode (for example GroupProbe::Scalar) to compare them.
+inline GroupProbe& activeGroupProbe() {
+#if defined(__SSE2__)
+    static GroupProbe probe = __builtin_cpu_supports("avx2") ? GroupProbe::AVX2 : GroupProbe::SSE2;
+#else
+    static GroupProbe probe = GroupProbe::Scalar;
+#endif
+    return probe;
+}
+
+//========================================================================================================================
+//                                                  Entries
+//========================================================================================================================
+// UPDATE: The engines used to store std::pair<K, T>. Now they store a HashEntry, which has the same first and second members
+// but the value is [[no_unique_address]]: when T is an empty type (like the NoValue of the HashSet) it takes no space at
+// all, while a std::pair<int, Empty> still takes 8 bytes because of the padding.
+template<typename K, typename T>
+struct HashEntry {
+    K first;
+    [[no_unique_address]] T second;
+
+    HashEntry() = default;
+
+    // Builds the key from key and the value from args (std::in_place so it is never confused with the copy constructor)
+    template<typename KeyArg, typename... Args>
+    HashEntry(std::in_place_t, KeyArg&& key, Args&&... args) : first(std::forward<KeyArg>(key)), second(std::forward<Args>(args)...) {}
+};
+
+//========================================================================================================================
+//                                                  Cached hash codes
+//========================================================================================================================
+// The engines can keep the full 64-bit hash of every key next to its entry. For strings and tuples this means that a lookup
+// compares the hashes before comparing the keys (two different strings are almost never compared), and a resize or a
+// backward shift never calls the hasher again. For scalar keys (int, long long, pointers...) the hash is only a few
+// multiplications, so storing it would only make the entries bigger (the AoC7 int memo got slower with it).
+// Specialize CacheHashCode for your key type to change the default.
+template<typename K>
+struct CacheHashCode : std::integral_constant<bool, !std::is_scalar<K>::value> {};
+
+// Base class of the entries of the engines. When the hash is not cached the class is empty and takes no space (empty base)
+template<typename K, bool Cached = CacheHashCode<K>::value>
+struct HashCache {
+    unsigned long long hash = 0;
+
+    void storeHash(unsigned long long value) { hash = value; }
+    bool matchesHash(unsigned long long value) const { return hash == value; } // If false the keys are surely different
+    template<typename Hash>
+    unsigned long long storedHash(const K&, const Hash&) const { return hash; }
+};
+
+template<typename K>
+struct HashCache<K, false> {
+    void storeHash(unsigned long long) {}
+    bool matchesHash(unsigned long long) const { return true; } // We do not know, the keys must be compared
+    template<typename Hash>
+    unsigned long long storedHash(const K& key, const Hash& hasher) const { return hasher(key); }
+};
+
+//========================================================================================================================
+//                                                  Statistics
+//========================================================================================================================
+// Compiling with -DHASHMAP_STATS turns on the statistics of every HashMap and HashSet: stats() gives the histogram of chain
+// lengths (probe lengths for the FlatTable), the longest chain, the load factor, how many times the table was rehashed,
+// the bytes it allocated and the hits and misses of its lookups, and statsJson() gives the same as a JSON object.
+// We added them because we chose the 0.75 load factor without ever looking at the chains. Without the macro none of the
+// counters exist (the maps have the same size) and the lines that update them are not compiled, so it costs nothing.
+#ifdef HASHMAP_STATS
+#define HASHMAP_STAT(statement) statement
+#else
+#define HASHMAP_STAT(statement)
+#endif
+
+#ifdef HASHMAP_STATS
+// Counters that an engine keeps while it runs, the rest of the statistics are computed by walking the table in stats()
+struct TableCounters {
+    long long rehashes = 0; // Times the bucket (or slot) array was replaced, the first allocation included
+    long long bytesAllocated = 0; // Total bytes ever allocated (freed memory is not subtracted)
+};
+
+// Counters of the lookups, kept by the HashMap and the HashSet
+struct LookupCounters {
+    long long hits = 0; // Lookups (find, get, contains...) that found the key, and insertions of a key that already existed
+    long long misses = 0; // Lookups that did not find the key
+    long long inserts = 0;
+    long long erases = 0;
+};
+
+struct HashMapStats {
+    const char* engine = "";
+    size_t elements = 0;
+    size_t buckets = 0; // Buckets, or slots for the FlatTable
+    double loadFactor = 0;
+    // For the chained engines histogram[n] is the number of buckets whose chain has n keys. For the FlatTable it is the number
+    // of keys that are found after looking at n slots (1 means the key is in its home slot)
+    const char* histogramOf = "";
+    std::vector<long long> histogram;
+    int maxChain = 0; // Longest chain, or longest probe sequence of a key for the FlatTable
+    double averageProbe = 0; // Keys compared (slots looked at) on average by a lookup that finds the key
+    long long rehashes = 0;
+    long long bytesAllocated = 0;
+    long long bytesInUse = 0; // Memory that the table holds right now (the list nodes are counted as the entry plus two pointers)
+    LookupCounters lookups;
+
+    // Adds 'count' chains (or keys) of the given length to the histogram
+    void addLength(int length, long long count = 1) {
+        if (length >= static_cast<int>(histogram.size())) histogram.resize(length + 1, 0);
+        histogram[length] += count;
+        if (count > 0) maxChain = std::max(maxChain, length);
+    }
+
+    // Fields that every engine fills in the same way. probes is the sum of the probe lengths of all the keys
+    void setTotals(size_t numElements, size_t numBuckets, long long probes, const TableCounters& counters, long long inUse) {
+        elements = numElements;
+        buckets = numBuckets;
+        loadFactor = numBuckets == 0 ? 0 : static_cast<double>(numElements) / numBuckets;
+        averageProbe = numElements == 0 ? 0 : static_cast<double>(probes) / numElements;
+        rehashes = counters.rehashes;
+        bytesAllocated = counters.bytesAllocated;
+        bytesInUse = inUse;
+    }
+
+    std::string toJson() const {
+        std::string json = "{\"engine\": \"" + std::string(engine) + "\", \"elements\": " + std::to_string(elements)
+            + ", \"buckets\": " + std::to_string(buckets) + ", \"load_factor\": " + std::to_string(loadFactor)
+            + ", \"histogram_of\": \"" + histogramOf + "\", \"histogram\": [";
+        for (size_t i = 0; i < histogram.size(); i++) {
+            json += (i == 0 ? "" : ", ") + std::to_string(histogram[i]);
+        }
+        json += "], \"max_chain\": " + std::to_string(maxChain) + ", \"average_probe\": " + std::to_string(averageProbe)
+            + ", \"rehashes\": " + std::to_string(rehashes) + ", \"bytes_allocated\": " + std::to_string(bytesAllocated)
+            + ", \"bytes_in_use\": " + std::to_string(bytesInUse) + ", \"hits\": " + std::to_string(lookups.hits)
+            + ", \"misses\": " + std::to_string(lookups.misses) + ", \"inserts\": " + std::to_string(lookups.inserts)
+            + ", \"erases\": " + std::to_string(lookups.erases) + "}";
+        return json;
+    }
+};
+#endif
+
+//========================================================================================================================
+//                                                  Storage engines
+//========================================================================================================================
+// UPDATE: The HashMap is now split in two layers. The storage engine (the "table") decides how the pairs are laid out in memory
+// and how collisions are resolved, and the HashMap class on top of it keeps the public API (set, get, getRef, contains, remove,
+// append, clear). This way Graph and the day solvers can switch the engine with a template parameter and benchmark both.
+// Every engine provides the same small set of primitives: findEntry, tryEmplace, erase, clear and size.
+// UPDATE: For the batched lookups of the HashMap (findMany, getMany, containsMany) every engine also has findEntryHashed,
+// the same lookup with a hash that was already computed, and two prefetch steps: prefetch(hash) asks the CPU to bring the
+// bucket (or slot) of the hash to the cache, and prefetchEntry(hash) reads that bucket and asks for the first entry of the
+// chain. They are only hints, nothing is modified and a wrong prefetch just wastes a bit of memory bandwidth.
+// UPDATE: Every engine also takes a std::pmr::memory_resource* (the heap by default) and allocates its nodes and buckets
+// from it, so a map can live in an Arena or a NodePool (see Allocators.h). Like the std::pmr containers, a copy of a table
+// goes back to the default resource and a move keeps the resource of the table it comes from.
+// UPDATE: With HASHMAP_STATS every engine also counts its rehashes and allocated bytes and has stats() (see Statistics above).
+// UPDATE: forEach(f) calls f(entry) for every stored entry, in no particular order (used by HashMap::forEach and freeze).
+// UPDATE: DirectTable (at the end) is not a hash table: for small integer keys the key is the slot. It has the same primitives
+// so a memo with dense integer keys switches to it with one template argument (DenseMap below is the short name).
+// UPDATE: EpochTable is a FlatTable without control bytes whose clear() is O(1), for memo tables reused across many queries.
+// UPDATE: BloomFront (after DirectTable) is not an engine by itself, it wraps one with a Bloom filter that answers most misses
+// without reading the table (BloomChainedTable, BloomFlatTable).
+
+// ChainedTable: our original separate chaining engine, a vector of buckets where each bucket is a linked list of pairs.
+template<typename K, typename T, typename Hash, typename Growth>
+class ChainedTable {
     private:
-        int hashSize; // We opted to make the hashSize dynamic
-        std::vector<std::list<std::pair<K, T>>> map;
+        // UPDATE: Every entry can keep the full hash of its key (see Cached hash codes above)
+        struct Entry : HashCache<K> {
+            HashEntry<K, T> kv;
+
+            template<typename... Args>
+            Entry(unsigned long long keyHash, Args&&... args) : kv(std::forward<Args>(args)...) {
+                this->storeHash(keyHash);
+            }
+        };
+
+        size_t hashSize; // We opted to make the hashSize dynamic (the Growth policy decides the valid sizes)
+        std::pmr::vector<std::pmr::list<Entry>> map; // The lists get the resource of the vector, so the nodes come from it too
         Hash hasher;
-        int numElements; // Track the number of elements
+        size_t numElements; // Track the number of elements
         const double loadFactorThreshold = 0.75; // Load factor threshold for resizing, have not tested if it is optimal, 
                                                  // but we found that 0.7-0.8 is usually a good value
+#ifdef HASHMAP_STATS
+        TableCounters counters;
+        static constexpr long long kNodeBytes = sizeof(Entry) + 2 * sizeof(void*); // A list node is the entry plus two pointers
+#endif
 
-        // Calculate hash for the key
-        int hashFunction(const K& key) const {
-            return hasher(key, hashSize);
+        // Bucket of a full hash value
+        size_t hashFunction(unsigned long long hash) const {
+            return Growth::index(hash, hashSize);
         }
 
-        // We added a resize method that resizes the hash table when load factor exceeds the threshold
-        void resize() {
-            int newHashSize = hashSize * 2; // Double the size
-            std::vector<std::list<std::pair<K, T>>> newMap(newHashSize); // We create the new hash table
+        // We added a resize method that resizes the hash table when load factor exceeds the threshold.
+        // UPDATE: It now receives the new size, so reserve() and shrink_to_fit() use it too (a size of 0 frees the buckets)
+        void resize(size_t newHashSize) {
+            std::pmr::vector<std::pmr::list<Entry>> newMap(newHashSize, map.get_allocator()); // We create the new hash table (same resource, so splice works)
+            HASHMAP_STAT(counters.rehashes++; counters.bytesAllocated += newHashSize * sizeof(std::pmr::list<Entry>));
 
-            // We rehash all existing elements into the new table
-            for (const auto& bucket : map) {
-                for (const auto& pair : bucket) {
-                    int newHash = hasher(pair.first, newHashSize);
-                    newMap[newHash].emplace_back(pair);
+            // We rehash all existing elements into the new table. We splice the list nodes instead of copying the pairs,
+            // so the pairs never move in memory and references returned before the resize are still valid
+            for (auto& bucket : map) {
+                while (!bucket.empty()) {
+                    const Entry& entry = bucket.front();
+                    size_t newHash = Growth::index(entry.storedHash(entry.kv.first, hasher), newHashSize); // No hashing if it is cached
+                    newMap[newHash].splice(newMap[newHash].end(), bucket, bucket.begin());
                 }
             }
 
@@ -108,108 +468,1716 @@ class HashMap {
         }
 
     public:
-        HashMap() : hashSize(25013), map(hashSize), numElements(0) {} // Now we initialize hashSize and numElements as we need them for resizing as default
+        // UPDATE: An empty table does not allocate anything, the buckets are created with the first insertion. Before, every map
+        // allocated 25013 list heads, and the Graph creates several maps for each query
+        explicit ChainedTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : hashSize(0), map(resource), numElements(0) {}
 
-        HashMap(int initialSize) : hashSize(initialSize), map(hashSize), numElements(0) {} // Constructor with custom initial size
+        ChainedTable(size_t initialSize, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : hashSize(Growth::bucketCount(initialSize)), map(hashSize, resource), numElements(0) {
+            HASHMAP_STAT(counters.bytesAllocated += hashSize * sizeof(std::pmr::list<Entry>));
+        }
 
-        // Here we insert or update the key-value pair
-        void set(const K& key, const T& value) {
-            int hash = hashFunction(key);
-            // Now we check if it already exists
-            for (auto& pair : map[hash]) {
-                if (pair.first == key) {
-                    pair.second = value; // Updates existing value
-                    return;
+        // Returns a pointer to the stored pair or nullptr if the key is not in the table
+        // The lookups are templates so the HashMap can probe with a type that is not K (heterogeneous lookup)
+        template<typename Q>
+        HashEntry<K, T>* findEntry(const Q& key) {
+            return const_cast<HashEntry<K, T>*>(static_cast<const ChainedTable*>(this)->findEntry(key));
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntry(const Q& key) const {
+            return findEntryHashed(key, hasher(key));
+        }
+
+        // Same lookup when the caller already has the hash of the key
+        template<typename Q>
+        const HashEntry<K, T>* findEntryHashed(const Q& key, unsigned long long hash) const {
+            if (hashSize == 0) return nullptr;
+            for (const Entry& entry : map[hashFunction(hash)]) {
+                if (entry.matchesHash(hash) && entry.kv.first == key) { // The keys are only compared when the full hashes match
+                    return &entry.kv;
                 }
             }
-            // If not found, we insert new key-value pair
-            map[hash].emplace_back(key, value);
-            numElements++;
+            return nullptr;
+        }
 
-            // We now check load factor and resize if necessary
-            if (static_cast<double>(numElements) / hashSize > loadFactorThreshold) { // We use static cast to avoid integer division
-                resize();
+        void prefetch(unsigned long long hash) const {
+            if (hashSize != 0) __builtin_prefetch(&map[hashFunction(hash)]);
+        }
+
+        void prefetchEntry(unsigned long long hash) const {
+            if (hashSize == 0) return;
+            const std::pmr::list<Entry>& bucket = map[hashFunction(hash)];
+            if (!bucket.empty()) __builtin_prefetch(&bucket.front()); // The first node of the chain is a second cache miss
+        }
+
+        template<typename F>
+        void forEach(F&& f) {
+            static_cast<const ChainedTable*>(this)->forEach([&](const HashEntry<K, T>& entry) { f(const_cast<HashEntry<K, T>&>(entry)); });
+        }
+
+        template<typename F>
+        void forEach(F&& f) const {
+            for (const auto& bucket : map) {
+                for (const Entry& entry : bucket) f(entry.kv);
             }
         }
 
-        // Append for vector types only - enables only when T is a vector (Solution helped with AI as we strugled with the correct enable_if syntax)
-        template<typename ElementType>
-        typename std::enable_if<std::is_same<T, std::vector<ElementType>>::value, void>::type // This enables the function only if T is vector<ElementType>
-        append(const K& key, const ElementType& value) { // Strings are also supported as they are vectors of char
-            for (auto& pair : map[hashFunction(key)]) {
-                if (pair.first == key) {
-                    pair.second.push_back(value); // Appends to existing vector
-                    return;
+        // Finds the key or inserts it with a value built from args. The bool tells if the key was inserted.
+        // The key is a forwarding reference, so a temporary key is moved into the table instead of copied
+        template<typename KeyArg, typename... Args>
+        std::pair<HashEntry<K, T>*, bool> tryEmplace(KeyArg&& key, Args&&... args) {
+            if (hashSize == 0) {
+                resize(Growth::bucketCount(Growth::initialSize)); // First insertion, now we allocate the buckets
+            }
+            unsigned long long hash = hasher(key);
+            auto& bucket = map[hashFunction(hash)];
+            for (Entry& entry : bucket) {
+                if (entry.matchesHash(hash) && entry.kv.first == key) {
+                    return {&entry.kv, false};
                 }
             }
-            // If not found, we insert new key-value pair with a vector containing the value
-            map[hashFunction(key)].emplace_back(key, T{value});
+            bucket.emplace_back(hash, std::in_place, std::forward<KeyArg>(key), std::forward<Args>(args)...);
+            HashEntry<K, T>* inserted = &bucket.back().kv;
             numElements++;
+            HASHMAP_STAT(counters.bytesAllocated += kNodeBytes);
 
             // We now check load factor and resize if necessary
-            if (static_cast<double>(numElements) / hashSize > loadFactorThreshold) {
-                resize();
+            if (static_cast<double>(numElements) / hashSize > loadFactorThreshold) { // We use static cast to avoid integer division
+                resize(Growth::grow(hashSize)); // The list nodes are spliced, so 'inserted' is still valid
             }
+            return {inserted, true};
         }
 
-        // We will add a size function to get the number of elements
-        int size() const {
+        bool erase(const K& key) {
+            if (hashSize == 0) return false;
+            unsigned long long hash = hasher(key);
+            auto& bucket = map[hashFunction(hash)];
+            for (auto it = bucket.begin(); it != bucket.end(); ++it) { // Iteration through the bucket for using erase function
+                if (it->matchesHash(hash) && it->kv.first == key) { // We found the key (would only work for structures with defined == operator)
+                    bucket.erase(it);
+                    numElements--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        size_t size() const {
             return numElements;
         }
 
-        // Now we add a fucntion for checking if a key exists
-        bool contains(const K& key) const {
-            int hash = hashFunction(key);
-            for (const auto& pair : map[hash]) {
-                if (pair.first == key) {
-                    return true;
+        size_t bucketCount() const {
+            return hashSize;
+        }
+
+        // Makes sure that n elements fit without any resize
+        void reserve(size_t n) {
+            size_t needed = bucketsFor<Growth>(n, loadFactorThreshold);
+            if (needed > hashSize) resize(needed);
+        }
+
+        // Sets the number of buckets to at least 'buckets' (never less than what the current elements need)
+        void rehash(size_t buckets) {
+            size_t needed = std::max(bucketsFor<Growth>(numElements, loadFactorThreshold), buckets > 0 ? Growth::bucketCount(buckets) : size_t(0));
+            if (needed != hashSize) resize(needed);
+        }
+
+        // Gives back the memory that the current elements do not need, an empty table frees all its buckets
+        void shrinkToFit() {
+            rehash(0);
+        }
+
+        void clear() {
+            for (auto& bucket : map) {
+                bucket.clear(); // We keep the bucket array instead of destroying and allocating it again
+            }
+            numElements = 0;
+        }
+
+#ifdef HASHMAP_STATS
+        HashMapStats stats() const {
+            HashMapStats result;
+            result.engine = "ChainedTable";
+            result.histogramOf = "chain length per bucket";
+            long long probes = 0;
+            for (const auto& bucket : map) {
+                int length = static_cast<int>(bucket.size());
+                result.addLength(length);
+                probes += 1LL * length * (length + 1) / 2; // The i-th key of a chain is found after i comparisons
+            }
+            result.setTotals(numElements, hashSize, probes, counters, map.capacity() * sizeof(std::pmr::list<Entry>) + numElements * kNodeBytes);
+            return result;
+        }
+#endif
+};
+
+// IncrementalTable: separate chaining like ChainedTable, but the resize is spread over the next operations instead of
+// rehashing every element at once. When the load factor is crossed we only allocate the new bucket array and keep the old
+// one next to it, then every insertion, lookup and removal moves a few old heads to the new array (kMigrateStep).
+// While both arrays exist a key is in the old array if its old bucket has not been moved yet, and in the new one otherwise,
+// so a lookup still walks a single bucket. This removes the pauses that grow with the size of the table in long running
+// memo workloads, at the cost of a slightly slower access while a migration is going on.
+// The heads are plain pointers to singly linked nodes instead of std::list: a vector of lists has to construct every
+// list head when it is created (a pause again), while a big calloc block comes from the OS already zeroed.
+// The nodes come from the memory resource, the bucket arrays keep using calloc for the zeroed pages.
+// Note: lookups also migrate, so even const lookups modify the table (it is not safe to read it from several threads at
+// the same time, use the ConcurrentHashMap for that). Nodes are only relinked, so the pairs never move in memory.
+template<typename K, typename T, typename Hash, typename Growth>
+class IncrementalTable {
+    private:
+        struct Node : HashCache<K> { // With the cached hash, migrating a bucket never calls the hasher
+            HashEntry<K, T> entry;
+            Node* next;
+
+            template<typename... Args>
+            Node(unsigned long long keyHash, Node* nextNode, Args&&... args) : entry(std::forward<Args>(args)...), next(nextNode) {
+                this->storeHash(keyHash);
+            }
+        };
+
+        static const size_t kMigrateStep = 8; // Old buckets moved per operation. The next resize happens after at least
+                                           // 0.75 * oldSize insertions, so with 2 or more the migration always ends before it
+        size_t hashSize;
+        Node** heads; // Current (new) buckets, each one is the head of a chain (nullptr if empty)
+        mutable Node** oldHeads; // Buckets that are still being moved, nullptr if no migration is going on
+        mutable size_t oldSize;
+        mutable size_t migrated; // Old buckets below this index have already been moved
+        Hash hasher;
+        size_t numElements;
+        const double loadFactorThreshold = 0.75;
+        std::pmr::memory_resource* resource; // Where the nodes come from
+#ifdef HASHMAP_STATS
+        TableCounters counters;
+#endif
+
+        template<typename... Args>
+        Node* newNode(Args&&... args) {
+            void* memory = resource->allocate(sizeof(Node), alignof(Node));
+            HASHMAP_STAT(counters.bytesAllocated += sizeof(Node));
+            try {
+                return new (memory) Node(std::forward<Args>(args)...);
+            } catch (...) {
+                resource->deallocate(memory, sizeof(Node), alignof(Node));
+                throw;
+            }
+        }
+
+        void deleteNode(Node* node) {
+            node->~Node();
+            resource->deallocate(node, sizeof(Node), alignof(Node));
+        }
+
+        static Node** allocateBuckets(size_t n) {
+            if (n == 0) return nullptr;
+            Node** result = static_cast<Node**>(std::calloc(n, sizeof(Node*)));
+            if (result == nullptr) throw std::bad_alloc();
+            return result;
+        }
+
+        // Moves up to 'steps' old buckets into the new array, and frees the old array when the last one is moved
+        void migrate(size_t steps) const {
+            for (; steps > 0 && migrated < oldSize; steps--, migrated++) {
+                Node* node = oldHeads[migrated];
+                while (node != nullptr) {
+                    Node* next = node->next;
+                    size_t newHash = Growth::index(node->storedHash(node->entry.first, hasher), hashSize);
+                    node->next = heads[newHash];
+                    heads[newHash] = node;
+                    node = next;
                 }
             }
-            return false;
+            if (migrated == oldSize) {
+                std::free(oldHeads);
+                oldHeads = nullptr;
+                oldSize = 0;
+                migrated = 0;
+            }
         }
 
-        // Now we add a function to get the value for a key
-        T get(const K& key) const {
-            int hash = hashFunction(key);
-            for (const auto& pair : map[hash]) {
-                if (pair.first == key) {
-                    return pair.second;
+        // Head of the chain where the key lives right now (in the old array if its old bucket has not been moved yet)
+        Node** chainOf(unsigned long long hash) const {
+            if (oldHeads != nullptr) {
+                size_t oldHash = Growth::index(hash, oldSize);
+                if (oldHash >= migrated) {
+                    return &oldHeads[oldHash];
                 }
             }
-            // In case the key does not exist, we throw an exception because we do not want to return a default value.
-            throw std::runtime_error("Key not found");
+            return &heads[Growth::index(hash, hashSize)];
         }
 
-        // UPDATE We added a function to get a const reference to the value for a key to avoid copying large structures
-        const T& getRef(const K& key) const { // We made it const so the caller cannot modify the original value
-            int hash = hashFunction(key);
-            for (const auto& pair : map[hash]) {
-                if (pair.first == key) {
-                    return pair.second;
+        // Starts an incremental resize: only the new bucket array is allocated here
+        void startResize(size_t newHashSize) {
+            if (oldHeads != nullptr) {
+                migrate(oldSize); // The previous migration must end before starting another one
+            }
+            Node** newBuckets = allocateBuckets(newHashSize);
+            HASHMAP_STAT(counters.rehashes++; counters.bytesAllocated += newHashSize * sizeof(Node*));
+            if (numElements == 0) {
+                std::free(heads); // Nothing to move
+            } else {
+                oldHeads = heads;
+                oldSize = hashSize;
+                migrated = 0;
+            }
+            heads = newBuckets;
+            hashSize = newHashSize;
+        }
+
+        // Stop-the-world resize, used by reserve, rehash and shrink_to_fit as they are explicit requests of the caller
+        void resize(size_t newHashSize) {
+            startResize(newHashSize);
+            if (oldHeads != nullptr) {
+                migrate(oldSize);
+            }
+        }
+
+        void destroyNodes() {
+            if (oldHeads != nullptr) {
+                migrate(oldSize);
+            }
+            for (size_t i = 0; i < hashSize && numElements > 0; i++) {
+                while (heads[i] != nullptr) {
+                    Node* next = heads[i]->next;
+                    deleteNode(heads[i]);
+                    heads[i] = next;
+                    numElements--;
                 }
             }
-            throw std::runtime_error("Key not found");
         }
-        
 
-        void remove(const K& key) {
-            int hash = hashFunction(key);
-            auto& bucket = map[hash];
-            for (auto it = bucket.begin(); it != bucket.end(); ++it) { // Iteration through the bucket for using erase function
-                if (it->first == key) { // We found the key (would only work for structures with defined == operator)
-                    bucket.erase(it);
+    public:
+        explicit IncrementalTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : hashSize(0), heads(nullptr), oldHeads(nullptr), oldSize(0), migrated(0), numElements(0), resource(resource) {}
+
+        IncrementalTable(size_t initialSize, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : hashSize(Growth::bucketCount(initialSize)), heads(allocateBuckets(hashSize)), oldHeads(nullptr), oldSize(0), migrated(0), numElements(0), resource(resource) {
+            HASHMAP_STAT(counters.bytesAllocated += hashSize * sizeof(Node*));
+        }
+
+        // As we manage the nodes ourselves we need the copy and move operations (the other engines get them from the vector)
+        IncrementalTable(const IncrementalTable& other) : IncrementalTable() {
+            *this = other;
+        }
+
+        IncrementalTable(IncrementalTable&& other) noexcept : IncrementalTable(other.resource) {
+            *this = std::move(other);
+        }
+
+        IncrementalTable& operator=(const IncrementalTable& other) {
+            if (this == &other) return *this;
+            destroyNodes();
+            std::free(heads);
+            hashSize = other.hashSize;
+            heads = allocateBuckets(hashSize);
+            HASHMAP_STAT(counters.bytesAllocated += hashSize * sizeof(Node*));
+            hasher = other.hasher;
+            if (other.oldHeads != nullptr) {
+                other.migrate(other.oldSize); // Copying is O(n) anyway, so we do not copy a migration in progress
+            }
+            for (size_t i = 0; i < hashSize; i++) {
+                for (Node* node = other.heads[i]; node != nullptr; node = node->next) {
+                    heads[i] = newNode(node->storedHash(node->entry.first, hasher), heads[i], node->entry);
+                }
+            }
+            numElements = other.numElements;
+            return *this;
+        }
+
+        // The nodes can only be taken if both tables use the same resource, otherwise they are copied into ours
+        IncrementalTable& operator=(IncrementalTable&& other) {
+            if (this == &other) return *this;
+            if (!resource->is_equal(*other.resource)) {
+                return *this = static_cast<const IncrementalTable&>(other);
+            }
+            destroyNodes();
+            std::free(heads);
+            std::swap(hashSize, other.hashSize);
+            std::swap(oldSize, other.oldSize);
+            std::swap(migrated, other.migrated);
+            std::swap(numElements, other.numElements);
+            std::swap(hasher, other.hasher);
+            heads = other.heads;
+            oldHeads = other.oldHeads;
+            other.heads = nullptr;
+            other.oldHeads = nullptr;
+            return *this;
+        }
+
+        ~IncrementalTable() {
+            destroyNodes();
+            std::free(heads);
+        }
+
+        template<typename Q>
+        HashEntry<K, T>* findEntry(const Q& key) {
+            return const_cast<HashEntry<K, T>*>(static_cast<const IncrementalTable*>(this)->findEntry(key));
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntry(const Q& key) const {
+            return findEntryHashed(key, hasher(key));
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntryHashed(const Q& key, unsigned long long hash) const {
+            if (hashSize == 0) return nullptr;
+            if (oldHeads != nullptr) migrate(kMigrateStep);
+            for (Node* node = *chainOf(hash); node != nullptr; node = node->next) {
+                if (node->matchesHash(hash) && node->entry.first == key) {
+                    return &node->entry;
+                }
+            }
+            return nullptr;
+        }
+
+        // The prefetches do not migrate, so they never change the table
+        void prefetch(unsigned long long hash) const {
+            if (hashSize != 0) __builtin_prefetch(chainOf(hash));
+        }
+
+        void prefetchEntry(unsigned long long hash) const {
+            if (hashSize == 0) return;
+            if (Node* node = *chainOf(hash)) __builtin_prefetch(node);
+        }
+
+        template<typename F>
+        void forEach(F&& f) {
+            static_cast<const IncrementalTable*>(this)->forEach([&](const HashEntry<K, T>& entry) { f(const_cast<HashEntry<K, T>&>(entry)); });
+        }
+
+        // It does not migrate, the old buckets that were not moved yet are visited where they are
+        template<typename F>
+        void forEach(F&& f) const {
+            for (size_t i = 0; i < hashSize; i++) {
+                for (const Node* node = heads[i]; node != nullptr; node = node->next) f(node->entry);
+            }
+            for (size_t i = migrated; i < oldSize; i++) {
+                for (const Node* node = oldHeads[i]; node != nullptr; node = node->next) f(node->entry);
+            }
+        }
+
+        template<typename KeyArg, typename... Args>
+        std::pair<HashEntry<K, T>*, bool> tryEmplace(KeyArg&& key, Args&&... args) {
+            if (hashSize == 0) {
+                startResize(Growth::bucketCount(Growth::initialSize));
+            }
+            if (oldHeads != nullptr) migrate(kMigrateStep);
+            unsigned long long hash = hasher(key);
+            Node** chain = chainOf(hash);
+            for (Node* node = *chain; node != nullptr; node = node->next) {
+                if (node->matchesHash(hash) && node->entry.first == key) {
+                    return {&node->entry, false};
+                }
+            }
+            Node* node = newNode(hash, *chain, std::in_place, std::forward<KeyArg>(key), std::forward<Args>(args)...);
+            *chain = node; // New nodes go to the front of the chain
+            numElements++;
+
+            if (static_cast<double>(numElements) / hashSize > loadFactorThreshold) {
+                startResize(Growth::grow(hashSize)); // Nothing is moved yet, the next operations will do it
+            }
+            return {&node->entry, true};
+        }
+
+        bool erase(const K& key) {
+            if (hashSize == 0) return false;
+            if (oldHeads != nullptr) migrate(kMigrateStep);
+            unsigned long long hash = hasher(key);
+            for (Node** link = chainOf(hash); *link != nullptr; link = &(*link)->next) {
+                if ((*link)->matchesHash(hash) && (*link)->entry.first == key) {
+                    Node* node = *link;
+                    *link = node->next;
+                    deleteNode(node);
                     numElements--;
-                    return;
+                    return true;
                 }
             }
-            throw std::runtime_error("Key not found for removal");
+            return false;
         }
 
-        void clear() { // Function for clearing the hash map
-            map.clear();
-            map.resize(hashSize);
-            numElements = 0;
+        size_t size() const {
+            return numElements;
+        }
+
+        size_t bucketCount() const {
+            return hashSize;
+        }
+
+        void reserve(size_t n) {
+            size_t needed = bucketsFor<Growth>(n, loadFactorThreshold);
+            if (needed > hashSize) resize(needed);
+        }
+
+        void rehash(size_t buckets) {
+            size_t needed = std::max(bucketsFor<Growth>(numElements, loadFactorThreshold), buckets > 0 ? Growth::bucketCount(buckets) : size_t(0));
+            if (needed != hashSize) resize(needed);
+        }
+
+        void shrinkToFit() {
+            rehash(0);
         }
+
+        void clear() {
+            destroyNodes(); // The bucket array is kept, like in the other engines
+        }
+
+#ifdef HASHMAP_STATS
+        // It does not migrate: the buckets of the old array that were not moved yet are counted as they are
+        HashMapStats stats() const {
+            HashMapStats result;
+            result.engine = "IncrementalTable";
+            result.histogramOf = "chain length per bucket";
+            long long probes = 0;
+            auto addChain = [&](const Node* node) {
+                int length = 0;
+                for (; node != nullptr; node = node->next) length++;
+                result.addLength(length);
+                probes += 1LL * length * (length + 1) / 2;
+            };
+            for (size_t i = 0; i < hashSize; i++) addChain(heads[i]);
+            for (size_t i = migrated; i < oldSize; i++) addChain(oldHeads[i]);
+            result.setTotals(numElements, hashSize, probes, counters, (hashSize + oldSize) * sizeof(Node*) + numElements * sizeof(Node));
+            return result;
+        }
+#endif
 };
 
-#endif
\ No newline at end of file
+// Returned by the findSlot of the open addressing engines when the key is not in the table (the slots are size_t)
+static const size_t kNoSlot = static_cast<size_t>(-1);
+
+// FlatTable: open addressing engine. Keys and values live in one contiguous array of slots, so a lookup walks neighbouring
+// memory instead of jumping from list node to list node. Collisions are solved with linear probing (if the home slot is taken
+// we try the next one) and removals use backward-shift deletion, which moves the following entries of the cluster one
+// position back so we never need tombstones. Keys and values must be default constructible as empty slots hold K() and T().
+// UPDATE: Lookups now go through the control bytes (see Control byte group probing above), a group of 16 or 32 slots is
+// filtered by fingerprint at once and we only compare the keys whose fingerprint matches.
+template<typename K, typename T, typename Hash, typename Growth>
+class FlatTable {
+    private:
+        // UPDATE: Each slot can also keep the full hash of its key (see Cached hash codes above), used to skip key comparisons
+        // when only the fingerprint matches, to find the home slot in the backward shift and to resize without the hasher
+        struct Slot : HashCache<K> {
+            HashEntry<K, T> kv;
+        };
+
+        size_t capacity; // Number of slots
+        std::pmr::vector<Slot> slots; // Contiguous storage of the pairs
+        std::pmr::vector<unsigned char> ctrl; // Control byte of each slot (kEmptyCtrl or the fingerprint), plus kMaxGroupWidth mirrored bytes
+        Hash hasher;
+        size_t numElements;
+        const double loadFactorThreshold = 0.75; // Same threshold as the chained table so the benchmark compares like for like
+#ifdef HASHMAP_STATS
+        TableCounters counters;
+#endif
+
+        // Home slot of a hash value, given by the growth policy
+        size_t homeSlot(unsigned long long hash) const {
+            return Growth::index(hash, capacity);
+        }
+
+        // The fingerprint is taken from the high bits of the hash multiplied by the golden ratio, so it does not depend on
+        // the low bits that already chose the home slot (even if a custom hash functor does not mix its bits)
+        static unsigned char fingerprint(unsigned long long hash) {
+            return static_cast<unsigned char>((hash * 0x9E3779B97F4A7C15ULL) >> 57);
+        }
+
+        // Next slot in the probe sequence, wrapping around at the end of the array
+        size_t nextSlot(size_t i) const {
+            return i + 1 == capacity ? 0 : i + 1;
+        }
+
+        // Writes a control byte and its mirrored copies, the bytes after the end repeat the first ones so a group
+        // that starts near the end of the array can be loaded without wrapping around
+        void setCtrl(size_t i, unsigned char value) {
+            ctrl[i] = value;
+            for (size_t j = i + capacity; j < capacity + kMaxGroupWidth; j += capacity) {
+                ctrl[j] = value;
+            }
+        }
+
+        GroupMatch matchGroup(size_t pos, unsigned char fp, int width) const {
+#if defined(__SSE2__)
+            if (width == 32) return matchGroupAVX2(&ctrl[pos], fp);
+            if (width == 16) return matchGroupSSE2(&ctrl[pos], fp);
+#endif
+            return matchGroupScalar(&ctrl[pos], fp, width);
+        }
+
+        // Returns the slot that holds the key or kNoSlot if it is not in the table
+        template<typename Q>
+        size_t findSlot(const Q& key, unsigned long long hash) const {
+            if (capacity == 0) return kNoSlot; // Nothing allocated yet
+            GroupProbe probe = activeGroupProbe();
+            int width = probe == GroupProbe::AVX2 ? 32 : (probe == GroupProbe::SSE2 ? 16 : 8);
+            unsigned char fp = fingerprint(hash);
+            size_t pos = homeSlot(hash);
+            // As the load factor is always below 1 there is at least one empty slot, so the loop always ends
+            while (true) {
+                GroupMatch group = matchGroup(pos, fp, width);
+                // Linear probing stops at the first empty slot, so we ignore the matches after it
+                unsigned int beforeEmpty = group.empty ? (group.empty & (0u - group.empty)) - 1 : ~0u;
+                for (unsigned int bits = group.match & beforeEmpty; bits; bits &= bits - 1) {
+                    size_t i = pos + __builtin_ctz(bits);
+                    if (i >= capacity) i -= capacity; // Mirrored byte, the real slot is at the beginning
+                    if (slots[i].matchesHash(hash) && slots[i].kv.first == key) {
+                        return i;
+                    }
+                }
+                if (group.empty) {
+                    return kNoSlot;
+                }
+                pos = (pos + width) % capacity;
+            }
+        }
+
+        // First empty slot in the probe sequence of a hash
+        size_t findEmptySlot(unsigned long long hash) const {
+            size_t i = homeSlot(hash);
+            while (ctrl[i] != kEmptyCtrl) i = nextSlot(i);
+            return i;
+        }
+
+        // Changes the capacity and reinserts every element (moving them, not copying). A capacity of 0 frees everything
+        void resize(size_t newCapacity) {
+            std::pmr::vector<Slot> oldSlots = std::move(slots); // The moved vectors keep their resource
+            std::pmr::vector<unsigned char> oldCtrl = std::move(ctrl);
+            capacity = newCapacity;
+            slots = std::pmr::vector<Slot>(capacity, oldSlots.get_allocator());
+            ctrl.assign(capacity == 0 ? 0 : capacity + kMaxGroupWidth, kEmptyCtrl);
+            HASHMAP_STAT(counters.rehashes++; counters.bytesAllocated += slots.capacity() * sizeof(Slot) + ctrl.capacity());
+            for (size_t i = 0; i < oldSlots.size(); i++) {
+                if (oldCtrl[i] == kEmptyCtrl) continue;
+                unsigned long long hash = oldSlots[i].storedHash(oldSlots[i].kv.first, hasher);
+                size_t j = findEmptySlot(hash);
+                slots[j] = std::move(oldSlots[i]);
+                setCtrl(j, fingerprint(hash));
+            }
+        }
+
+    public:
+        explicit FlatTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : capacity(0), slots(resource), ctrl(resource), numElements(0) {} // Allocation free until the first insertion
+
+        FlatTable(size_t initialSize, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : capacity(Growth::bucketCount(initialSize)), slots(capacity, resource), ctrl(capacity + kMaxGroupWidth, kEmptyCtrl, resource), numElements(0) {
+            HASHMAP_STAT(counters.bytesAllocated += slots.capacity() * sizeof(Slot) + ctrl.capacity());
+        }
+
+        template<typename Q>
+        HashEntry<K, T>* findEntry(const Q& key) {
+            size_t i = findSlot(key, hasher(key));
+            return i == kNoSlot ? nullptr : &slots[i].kv;
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntry(const Q& key) const {
+            size_t i = findSlot(key, hasher(key));
+            return i == kNoSlot ? nullptr : &slots[i].kv;
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntryHashed(const Q& key, unsigned long long hash) const {
+            size_t i = findSlot(key, hash);
+            return i == kNoSlot ? nullptr : &slots[i].kv;
+        }
+
+        // We only ask for the home slot. The control bytes are 16 times smaller than the slots and stay in the L3 cache for
+        // much bigger tables, prefetching them too made the batched lookups slower in our benchmark (see BENCHMARKS)
+        void prefetch(unsigned long long hash) const {
+            if (capacity != 0) __builtin_prefetch(&slots[homeSlot(hash)]);
+        }
+
+        void prefetchEntry(unsigned long long) const {} // Nothing to follow, the slot was already requested by prefetch
+
+        template<typename F>
+        void forEach(F&& f) {
+            static_cast<const FlatTable*>(this)->forEach([&](const HashEntry<K, T>& entry) { f(const_cast<HashEntry<K, T>&>(entry)); });
+        }
+
+        template<typename F>
+        void forEach(F&& f) const {
+            for (size_t i = 0; i < capacity; i++) {
+                if (ctrl[i] != kEmptyCtrl) f(slots[i].kv);
+            }
+        }
+
+        template<typename KeyArg, typename... Args>
+        std::pair<HashEntry<K, T>*, bool> tryEmplace(KeyArg&& key, Args&&... args) {
+            unsigned long long hash = hasher(key); // We hash only once for the lookup and the insertion
+            size_t i = findSlot(key, hash);
+            if (i != kNoSlot) {
+                return {&slots[i].kv, false};
+            }
+            // Unlike the chained table we resize before inserting, so the pointer we return is the final position
+            if (numElements + 1 > loadFactorThreshold * capacity) { // Written as a product so an empty table (capacity 0) also works
+                resize(capacity == 0 ? Growth::bucketCount(Growth::initialSize) : Growth::grow(capacity));
+            }
+            i = findEmptySlot(hash);
+            slots[i].kv.first = std::forward<KeyArg>(key);
+            slots[i].kv.second = T(std::forward<Args>(args)...);
+            slots[i].storeHash(hash);
+            setCtrl(i, fingerprint(hash));
+            numElements++;
+            return {&slots[i].kv, true};
+        }
+
+        // Backward-shift deletion: after emptying slot i we walk the rest of the cluster and move back every entry whose
+        // home slot is not between the hole and its current position, otherwise a later lookup would stop at the hole
+        bool erase(const K& key) {
+            size_t hole = findSlot(key, hasher(key));
+            if (hole == kNoSlot) {
+                return false;
+            }
+            for (size_t j = nextSlot(hole); ctrl[j] != kEmptyCtrl; j = nextSlot(j)) {
+                size_t home = homeSlot(slots[j].storedHash(slots[j].kv.first, hasher));
+                bool staysInPlace = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j); // Cyclic range (hole, j]
+                if (!staysInPlace) {
+                    slots[hole] = std::move(slots[j]);
+                    setCtrl(hole, ctrl[j]);
+                    hole = j;
+                }
+            }
+            slots[hole] = Slot(); // We release whatever the moved-from pair still holds
+            setCtrl(hole, kEmptyCtrl);
+            numElements--;
+            return true;
+        }
+
+        size_t size() const {
+            return numElements;
+        }
+
+        size_t bucketCount() const {
+            return capacity;
+        }
+
+        void reserve(size_t n) {
+            size_t needed = bucketsFor<Growth>(n, loadFactorThreshold);
+            if (needed > capacity) resize(needed);
+        }
+
+        void rehash(size_t buckets) {
+            size_t needed = std::max(bucketsFor<Growth>(numElements, loadFactorThreshold), buckets > 0 ? Growth::bucketCount(buckets) : size_t(0));
+            if (needed != capacity) resize(needed);
+        }
+
+        void shrinkToFit() {
+            rehash(0);
+        }
+
+        void clear() {
+            if (numElements == 0) return; // Nothing to reset (this also keeps an unallocated table unallocated)
+            slots.assign(capacity, Slot());
+            ctrl.assign(capacity + kMaxGroupWidth, kEmptyCtrl);
+            numElements = 0;
+        }
+
+#ifdef HASHMAP_STATS
+        HashMapStats stats() const {
+            HashMapStats result;
+            result.engine = "FlatTable";
+            result.histogramOf = "probe length per key";
+            long long probes = 0;
+            for (size_t i = 0; i < capacity; i++) {
+                if (ctrl[i] == kEmptyCtrl) continue;
+                size_t home = homeSlot(slots[i].storedHash(slots[i].kv.first, hasher));
+                int length = static_cast<int>((i + capacity - home) % capacity + 1); // Slots from the home slot to this one, both included
+                result.addLength(length);
+                probes += length;
+            }
+            result.setTotals(numElements, capacity, probes, counters, slots.capacity() * sizeof(Slot) + ctrl.capacity());
+            return result;
+        }
+#endif
+};
+
+// EpochTable: open addressing with linear probing like the FlatTable, but every slot keeps the epoch (generation) in which it
+// was written and a slot is only used if its epoch is the current one. clear() just moves to the next epoch, so all the
+// slots become empty at once without touching the memory: O(1) instead of O(capacity). It is made for memo tables that are
+// reused for many queries (or rows) instead of building a new map for each one, and whose capacity stays from one use
+// to the next. The stale slots still hold their old pairs until they are overwritten or the table is destroyed, so it is
+// not a good fit for values that own a lot of memory. Every few billion clears the epoch counter wraps around and that clear
+// resets all the slots. No control bytes: the epoch check is what tells if a slot is empty.
+template<typename K, typename T, typename Hash, typename Growth>
+class EpochTable {
+    private:
+        struct Slot : HashCache<K> {
+            unsigned int stamp = 0; // Epoch of the last write, 0 is never a valid epoch so a new slot is empty
+            HashEntry<K, T> kv;
+        };
+
+        size_t capacity;
+        std::pmr::vector<Slot> slots;
+        Hash hasher;
+        size_t numElements;
+        unsigned int epoch; // Current epoch, starts at 1
+        const double loadFactorThreshold = 0.75;
+#ifdef HASHMAP_STATS
+        TableCounters counters;
+#endif
+
+        bool isLive(size_t i) const {
+            return slots[i].stamp == epoch;
+        }
+
+        size_t homeSlot(unsigned long long hash) const {
+            return Growth::index(hash, capacity);
+        }
+
+        size_t nextSlot(size_t i) const {
+            return i + 1 == capacity ? 0 : i + 1;
+        }
+
+        template<typename Q>
+        size_t findSlot(const Q& key, unsigned long long hash) const {
+            if (capacity == 0) return kNoSlot;
+            for (size_t i = homeSlot(hash); isLive(i); i = nextSlot(i)) { // The load factor keeps at least one slot empty
+                if (slots[i].matchesHash(hash) && slots[i].kv.first == key) {
+                    return i;
+                }
+            }
+            return kNoSlot;
+        }
+
+        size_t findEmptySlot(unsigned long long hash) const {
+            size_t i = homeSlot(hash);
+            while (isLive(i)) i = nextSlot(i);
+            return i;
+        }
+
+        // Same as the FlatTable, only the live slots are moved to the new array (the stale ones are dropped here)
+        void resize(size_t newCapacity) {
+            std::pmr::vector<Slot> oldSlots = std::move(slots);
+            capacity = newCapacity;
+            slots = std::pmr::vector<Slot>(capacity, oldSlots.get_allocator());
+            HASHMAP_STAT(counters.rehashes++; counters.bytesAllocated += slots.capacity() * sizeof(Slot));
+            for (Slot& slot : oldSlots) {
+                if (slot.stamp != epoch) continue;
+                unsigned long long hash = slot.storedHash(slot.kv.first, hasher);
+                slots[findEmptySlot(hash)] = std::move(slot);
+            }
+        }
+
+    public:
+        explicit EpochTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : capacity(0), slots(resource), numElements(0), epoch(1) {}
+
+        EpochTable(size_t initialSize, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : capacity(Growth::bucketCount(initialSize)), slots(capacity, resource), numElements(0), epoch(1) {
+            HASHMAP_STAT(counters.bytesAllocated += slots.capacity() * sizeof(Slot));
+        }
+
+        template<typename Q>
+        HashEntry<K, T>* findEntry(const Q& key) {
+            size_t i = findSlot(key, hasher(key));
+            return i == kNoSlot ? nullptr : &slots[i].kv;
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntry(const Q& key) const {
+            size_t i = findSlot(key, hasher(key));
+            return i == kNoSlot ? nullptr : &slots[i].kv;
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntryHashed(const Q& key, unsigned long long hash) const {
+            size_t i = findSlot(key, hash);
+            return i == kNoSlot ? nullptr : &slots[i].kv;
+        }
+
+        void prefetch(unsigned long long hash) const {
+            if (capacity != 0) __builtin_prefetch(&slots[homeSlot(hash)]);
+        }
+
+        void prefetchEntry(unsigned long long) const {}
+
+        template<typename F>
+        void forEach(F&& f) {
+            static_cast<const EpochTable*>(this)->forEach([&](const HashEntry<K, T>& entry) { f(const_cast<HashEntry<K, T>&>(entry)); });
+        }
+
+        template<typename F>
+        void forEach(F&& f) const {
+            for (size_t i = 0; i < capacity; i++) {
+                if (isLive(i)) f(slots[i].kv);
+            }
+        }
+
+        template<typename KeyArg, typename... Args>
+        std::pair<HashEntry<K, T>*, bool> tryEmplace(KeyArg&& key, Args&&... args) {
+            unsigned long long hash = hasher(key);
+            size_t i = findSlot(key, hash);
+            if (i != kNoSlot) {
+                return {&slots[i].kv, false};
+            }
+            if (numElements + 1 > loadFactorThreshold * capacity) {
+                resize(capacity == 0 ? Growth::bucketCount(Growth::initialSize) : Growth::grow(capacity));
+            }
+            i = findEmptySlot(hash);
+            slots[i].kv.first = std::forward<KeyArg>(key); // The slot may hold a stale pair, we overwrite it
+            slots[i].kv.second = T(std::forward<Args>(args)...);
+            slots[i].storeHash(hash);
+            slots[i].stamp = epoch;
+            numElements++;
+            return {&slots[i].kv, true};
+        }
+
+        // Backward-shift deletion like the FlatTable, a slot of another epoch ends the cluster like an empty one
+        bool erase(const K& key) {
+            size_t hole = findSlot(key, hasher(key));
+            if (hole == kNoSlot) {
+                return false;
+            }
+            for (size_t j = nextSlot(hole); isLive(j); j = nextSlot(j)) {
+                size_t home = homeSlot(slots[j].storedHash(slots[j].kv.first, hasher));
+                bool staysInPlace = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+                if (!staysInPlace) {
+                    slots[hole] = std::move(slots[j]);
+                    hole = j;
+                }
+            }
+            slots[hole] = Slot(); // Stamp 0, empty in every epoch
+            numElements--;
+            return true;
+        }
+
+        size_t size() const {
+            return numElements;
+        }
+
+        size_t bucketCount() const {
+            return capacity;
+        }
+
+        void reserve(size_t n) {
+            size_t needed = bucketsFor<Growth>(n, loadFactorThreshold);
+            if (needed > capacity) resize(needed);
+        }
+
+        void rehash(size_t buckets) {
+            size_t needed = std::max(bucketsFor<Growth>(numElements, loadFactorThreshold), buckets > 0 ? Growth::bucketCount(buckets) : size_t(0));
+            if (needed != capacity) resize(needed);
+        }
+
+        void shrinkToFit() {
+            rehash(0);
+        }
+
+        // O(1): the slots of the old epoch are empty from now on. Only when the counter wraps around we reset the stamps,
+        // otherwise a slot written 2^32 clears ago would come back
+        void clear() {
+            numElements = 0;
+            if (++epoch == 0) {
+                for (Slot& slot : slots) slot.stamp = 0;
+                epoch = 1;
+            }
+        }
+
+#ifdef HASHMAP_STATS
+        HashMapStats stats() const {
+            HashMapStats result;
+            result.engine = "EpochTable";
+            result.histogramOf = "probe length per key";
+            long long probes = 0;
+            for (size_t i = 0; i < capacity; i++) {
+                if (!isLive(i)) continue;
+                size_t home = homeSlot(slots[i].storedHash(slots[i].kv.first, hasher));
+                int length = static_cast<int>((i + capacity - home) % capacity + 1);
+                result.addLength(length);
+                probes += length;
+            }
+            result.setTotals(numElements, capacity, probes, counters, slots.capacity() * sizeof(Slot));
+            return result;
+        }
+#endif
+};
+
+// DirectTable: direct-address engine for small non-negative integer keys (like the row * cols + col keys of AoC7), the key
+// itself is the index of its slot, so there is no hashing, no collisions and no probing. The pairs live in one array with
+// a bit per slot that tells if it is used. The array covers the keys [0, range): reserve(n) and the initialSize of the
+// constructor set the range when it is known, and inserting a bigger key grows it (at least to the double, like a vector).
+// It only makes sense when the keys are dense: the memory depends on the biggest key and not on the number of keys.
+// Negative keys can not be inserted (they throw) and are never found. Like the FlatTable, T must be default constructible
+// and a growth moves the pairs, so pointers are valid until the next insertion. The Hash and Growth parameters are not used.
+template<typename K, typename T, typename Hash, typename Growth>
+class DirectTable {
+    static_assert(std::is_integral<K>::value, "DirectTable only works with integer keys");
+
+    private:
+        size_t range; // Keys [0, range) have a slot
+        std::pmr::vector<HashEntry<K, T>> slots; // slots[key] is the pair of key (the key is kept so findEntry can return the pair)
+        std::pmr::vector<unsigned long long> used; // Bit key % 64 of word key / 64 tells if the key is in the table
+        size_t numElements;
+        static constexpr size_t kMinRange = 64; // First growth of a table created empty (one word of bits)
+#ifdef HASHMAP_STATS
+        TableCounters counters;
+#endif
+
+        bool isUsed(long long key) const {
+            return (used[key >> 6] >> (key & 63)) & 1;
+        }
+
+        // Slot of the key, or -1 if the key is out of the range or not in the table
+        template<typename Q>
+        long long findSlot(const Q& key) const {
+            long long i = static_cast<long long>(key);
+            return i >= 0 && static_cast<size_t>(i) < range && isUsed(i) ? i : -1;
+        }
+
+        // Changes the range, the pairs are moved. The keys that are in the table must be below newRange
+        void resize(size_t newRange) {
+            range = newRange;
+            slots.resize(range);
+            used.resize((range + 63) / 64, 0);
+            if (range == 0) { // Frees everything (shrinkToFit of an empty table)
+                slots.shrink_to_fit();
+                used.shrink_to_fit();
+            }
+            HASHMAP_STAT(counters.rehashes++; counters.bytesAllocated += slots.capacity() * sizeof(HashEntry<K, T>) + used.capacity() * sizeof(unsigned long long));
+        }
+
+        // Biggest key in the table plus one (0 if it is empty)
+        size_t usedRange() const {
+            for (size_t w = used.size(); w-- > 0;) {
+                if (used[w] != 0) return w * 64 + 64 - __builtin_clzll(used[w]);
+            }
+            return 0;
+        }
+
+    public:
+        explicit DirectTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : range(0), slots(resource), used(resource), numElements(0) {} // Allocation free until the first insertion
+
+        // initialSize is the range of keys, not a number of buckets
+        DirectTable(size_t initialSize, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : range(0), slots(resource), used(resource), numElements(0) {
+            if (initialSize > 0) resize(initialSize);
+        }
+
+        template<typename Q>
+        HashEntry<K, T>* findEntry(const Q& key) {
+            long long i = findSlot(key);
+            return i < 0 ? nullptr : &slots[i];
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntry(const Q& key) const {
+            long long i = findSlot(key);
+            return i < 0 ? nullptr : &slots[i];
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntryHashed(const Q& key, unsigned long long) const { // The hash is not needed
+            return findEntry(key);
+        }
+
+        // The slot depends on the key and not on the hash, so there is nothing to prefetch from a hash. The batched lookups
+        // still work, they just do one direct lookup per key
+        void prefetch(unsigned long long) const {}
+
+        void prefetchEntry(unsigned long long) const {}
+
+        template<typename F>
+        void forEach(F&& f) {
+            static_cast<const DirectTable*>(this)->forEach([&](const HashEntry<K, T>& entry) { f(const_cast<HashEntry<K, T>&>(entry)); });
+        }
+
+        template<typename F>
+        void forEach(F&& f) const {
+            for (size_t w = 0; w < used.size(); w++) {
+                for (unsigned long long bits = used[w]; bits; bits &= bits - 1) f(slots[w * 64 + __builtin_ctzll(bits)]);
+            }
+        }
+
+        template<typename KeyArg, typename... Args>
+        std::pair<HashEntry<K, T>*, bool> tryEmplace(KeyArg&& key, Args&&... args) {
+            long long i = static_cast<long long>(key);
+            if (i < 0) {
+                throw std::out_of_range("DirectTable: negative key");
+            }
+            if (static_cast<size_t>(i) >= range) {
+                resize(std::max({static_cast<size_t>(i) + 1, 2 * range, kMinRange})); // Like FlatTable we grow before inserting
+            } else if (isUsed(i)) {
+                return {&slots[i], false};
+            }
+            slots[i].first = std::forward<KeyArg>(key);
+            slots[i].second = T(std::forward<Args>(args)...);
+            used[i >> 6] |= 1ULL << (i & 63);
+            numElements++;
+            return {&slots[i], true};
+        }
+
+        bool erase(const K& key) {
+            long long i = findSlot(key);
+            if (i < 0) {
+                return false;
+            }
+            used[i >> 6] &= ~(1ULL << (i & 63));
+            slots[i].second = T(); // We release whatever the value holds
+            numElements--;
+            return true;
+        }
+
+        size_t size() const {
+            return numElements;
+        }
+
+        // The range of keys (number of slots)
+        size_t bucketCount() const {
+            return range;
+        }
+
+        // Makes room for the keys [0, n)
+        void reserve(size_t n) {
+            if (n > range) resize(n);
+        }
+
+        // Sets the range to 'buckets', but never below the biggest key in the table
+        void rehash(size_t buckets) {
+            size_t needed = std::max(usedRange(), buckets);
+            if (needed != range) resize(needed);
+        }
+
+        void shrinkToFit() {
+            rehash(0);
+        }
+
+        void clear() {
+            forEach([](HashEntry<K, T>& entry) { entry.second = T(); });
+            std::fill(used.begin(), used.end(), 0);
+            numElements = 0;
+        }
+
+#ifdef HASHMAP_STATS
+        HashMapStats stats() const {
+            HashMapStats result;
+            result.engine = "DirectTable";
+            result.histogramOf = "probe length per key";
+            result.addLength(1, numElements); // Every key is in its own slot
+            result.setTotals(numElements, range, numElements, counters, slots.capacity() * sizeof(HashEntry<K, T>) + used.capacity() * sizeof(unsigned long long));
+            return result;
+        }
+#endif
+};
+
+//========================================================================================================================
+//                                              Bloom filter front
+//========================================================================================================================
+// Many of our lookups miss (the dedup checks, forwardAdjacents.contains() on the leaf nodes, visited.contains() in a BFS),
+// and a miss still reads the bucket (and the chain) of the key. BloomFront puts a blocked Bloom filter in front of another
+// engine: a key that the filter has never seen is rejected without touching the memory of the table, and only the keys
+// that may be there (the ones that are, plus a small rate of false positives) go to the engine.
+// Every key sets 8 bits of one 64-byte block (one cache line), one bit in each of its 8 words, so a check reads a single
+// line: the block comes from the high bits of the hash and the 8 bit positions from the low 32 bits multiplied by 8
+// constants (6 bits each). With AVX2 the 8 positions are computed and tested in a few instructions, otherwise in a loop.
+// A Bloom filter can not remove keys: erased keys keep their bits until the next rebuild (false positives, never a false
+// negative), and the filter is rebuilt from the table when the keys inserted since the last rebuild pass its capacity.
+
+struct alignas(64) BloomBlock {
+    unsigned long long words[8];
+};
+
+// Odd multipliers that pick the bit of each word (the ones of the split block Bloom filter of Parquet)
+alignas(32) static const unsigned int kBloomSalts[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+inline bool bloomCheckScalar(const BloomBlock& block, unsigned int h) {
+    bool all = true;
+    for (int i = 0; i < 8; i++) {
+        all &= (block.words[i] >> ((h * kBloomSalts[i]) >> 26)) & 1;
+    }
+    return all;
+}
+
+#if defined(__SSE2__)
+// Compiled for AVX2 like matchGroupAVX2, only called when the CPU has it
+__attribute__((target("avx2"))) inline bool bloomCheckAVX2(const BloomBlock& block, unsigned int h) {
+    __m256i salts = _mm256_load_si256(reinterpret_cast<const __m256i*>(kBloomSalts));
+    __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(h)), salts), 26);
+    __m256i one = _mm256_set1_epi64x(1);
+    __m256i maskLow = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shifts))); // Words 0 to 3
+    __m256i maskHigh = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shifts, 1))); // Words 4 to 7
+    __m256i wordsLow = _mm256_load_si256(reinterpret_cast<const __m256i*>(block.words));
+    __m256i wordsHigh = _mm256_load_si256(reinterpret_cast<const __m256i*>(block.words + 4));
+    return _mm256_testc_si256(wordsLow, maskLow) & _mm256_testc_si256(wordsHigh, maskHigh); // testc: all the bits of the mask are set
+}
+#endif
+
+class BlockedBloomFilter {
+    private:
+        std::pmr::vector<BloomBlock> blocks; // A power of two number of blocks (none until the first reset)
+        unsigned long long blockMask;
+
+        const BloomBlock& blockOf(unsigned long long hash) const {
+            return blocks[((hash * 0x9e3779b97f4a7c15ULL) >> 32) & blockMask]; // Multiplied so a weak hash still spreads over the blocks
+        }
+
+    public:
+        explicit BlockedBloomFilter(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : blocks(resource), blockMask(0) {}
+
+        // Empties the filter and sizes it for 'keys' keys with bitsPerKey bits each (rounded up to a power of two of blocks)
+        void reset(size_t keys, int bitsPerKey) {
+            size_t needed = (keys * bitsPerKey + 511) / 512;
+            size_t count = 1;
+            while (count < needed) count *= 2;
+            blocks.assign(count, BloomBlock{});
+            blockMask = count - 1;
+        }
+
+        // Empties the filter, keeping its size
+        void clear() {
+            std::fill(blocks.begin(), blocks.end(), BloomBlock{});
+        }
+
+        void add(unsigned long long hash) {
+            BloomBlock& block = const_cast<BloomBlock&>(blockOf(hash));
+            unsigned int h = static_cast<unsigned int>(hash);
+            for (int i = 0; i < 8; i++) {
+                block.words[i] |= 1ULL << ((h * kBloomSalts[i]) >> 26);
+            }
+        }
+
+        // False means that the key was never added, true that it may have been
+        bool mayContain(unsigned long long hash) const {
+            if (blocks.empty()) return false;
+#if defined(__SSE2__)
+            if (activeGroupProbe() == GroupProbe::AVX2) return bloomCheckAVX2(blockOf(hash), static_cast<unsigned int>(hash));
+#endif
+            return bloomCheckScalar(blockOf(hash), static_cast<unsigned int>(hash));
+        }
+
+        void prefetch(unsigned long long hash) const {
+            if (!blocks.empty()) __builtin_prefetch(&blockOf(hash));
+        }
+
+        // Keys that fit with bitsPerKey bits each
+        size_t capacity(int bitsPerKey) const {
+            return blocks.size() * 512 / bitsPerKey;
+        }
+
+        size_t memoryBytes() const {
+            return blocks.capacity() * sizeof(BloomBlock);
+        }
+};
+
+// BloomFront<Inner, ...>: the engine Inner with the filter in front of its lookups. Use it through the aliases below, for
+// example HashMap<int, long long, DefaultHash<int>, BloomFlatTable> or HashSet<string, DefaultHash<string>, BloomChainedTable>.
+// It only pays off when most lookups miss and the table does not fit in the cache while the filter (2 to 4 bytes per key) does.
+// Insertions hash the key one more time for the filter, and clear() also zeroes the filter (O(filter), even with EpochTable).
+template<template<typename, typename, typename, typename> class Inner, typename K, typename T, typename Hash, typename Growth>
+class BloomFront {
+    private:
+        Inner<K, T, Hash, Growth> table;
+        BlockedBloomFilter filter;
+        Hash hasher;
+        size_t filterKeys; // Keys the filter was sized for
+        size_t added; // Keys added to the filter since the last rebuild (erased keys included, their bits are still set)
+        static constexpr int kBitsPerKey = 16; // About 0.1-0.2% of false positives when the filter is full (see BENCHMARKS/BloomFilter)
+        static constexpr size_t kMinKeys = 64;
+#ifdef HASHMAP_STATS
+        TableCounters counters;
+#endif
+
+        // Sizes the filter for 'keys' keys and adds the keys of the table again, which also forgets the erased ones
+        void rebuild(size_t keys) {
+            filter.reset(std::max(keys, kMinKeys), kBitsPerKey);
+            HASHMAP_STAT(counters.rehashes++; counters.bytesAllocated += filter.memoryBytes());
+            filterKeys = filter.capacity(kBitsPerKey);
+            added = table.size();
+            table.forEach([&](const HashEntry<K, T>& entry) { filter.add(hasher(entry.first)); });
+        }
+
+    public:
+        explicit BloomFront(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : table(resource), filter(resource), filterKeys(0), added(0) {}
+
+        BloomFront(size_t initialSize, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : table(initialSize, resource), filter(resource), filterKeys(0), added(0) {
+            rebuild(initialSize);
+        }
+
+        template<typename Q>
+        HashEntry<K, T>* findEntry(const Q& key) {
+            return const_cast<HashEntry<K, T>*>(static_cast<const BloomFront*>(this)->findEntry(key));
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntry(const Q& key) const {
+            return findEntryHashed(key, hasher(key));
+        }
+
+        template<typename Q>
+        const HashEntry<K, T>* findEntryHashed(const Q& key, unsigned long long hash) const {
+            if (!filter.mayContain(hash)) return nullptr; // Definite miss, the table is not touched
+            return table.findEntryHashed(key, hash);
+        }
+
+        // Batched lookups: the first step brings the block of the filter and the bucket, the second one only follows the
+        // chain of the keys that pass the filter
+        void prefetch(unsigned long long hash) const {
+            filter.prefetch(hash);
+            table.prefetch(hash);
+        }
+
+        void prefetchEntry(unsigned long long hash) const {
+            if (filter.mayContain(hash)) table.prefetchEntry(hash);
+        }
+
+        template<typename F>
+        void forEach(F&& f) {
+            table.forEach(std::forward<F>(f));
+        }
+
+        template<typename F>
+        void forEach(F&& f) const {
+            table.forEach(std::forward<F>(f));
+        }
+
+        template<typename KeyArg, typename... Args>
+        std::pair<HashEntry<K, T>*, bool> tryEmplace(KeyArg&& key, Args&&... args) {
+            unsigned long long hash = hasher(key); // Before the key is moved into the table
+            auto result = table.tryEmplace(std::forward<KeyArg>(key), std::forward<Args>(args)...);
+            if (result.second) {
+                if (++added > filterKeys) {
+                    rebuild(2 * table.size()); // Adds the new key too. The entries do not move, so result is still valid
+                } else {
+                    filter.add(hash);
+                }
+            }
+            return result;
+        }
+
+        bool erase(const K& key) {
+            return table.erase(key); // The bits stay, 'added' still counts the key until the next rebuild
+        }
+
+        size_t size() const {
+            return table.size();
+        }
+
+        size_t bucketCount() const {
+            return table.bucketCount();
+        }
+
+        void reserve(size_t n) {
+            table.reserve(n);
+            if (n > filterKeys) rebuild(n);
+        }
+
+        void rehash(size_t buckets) {
+            table.rehash(buckets);
+        }
+
+        void shrinkToFit() {
+            table.shrinkToFit();
+            rebuild(2 * table.size());
+        }
+
+        void clear() {
+            table.clear();
+            filter.clear();
+            added = 0;
+        }
+
+#ifdef HASHMAP_STATS
+        HashMapStats stats() const {
+            HashMapStats result = table.stats();
+            static const std::string name = std::string("BloomFront<") + result.engine + ">";
+            result.engine = name.c_str();
+            result.rehashes += counters.rehashes; // The filter rebuilds count as rehashes
+            result.bytesAllocated += counters.bytesAllocated;
+            result.bytesInUse += filter.memoryBytes();
+            return result;
+        }
+#endif
+};
+
+// The aliases are what goes in the Storage parameter (it takes a template of 4 parameters)
+template<typename K, typename T, typename Hash, typename Growth>
+using BloomChainedTable = BloomFront<ChainedTable, K, T, Hash, Growth>;
+
+template<typename K, typename T, typename Hash, typename Growth>
+using BloomFlatTable = BloomFront<FlatTable, K, T, Hash, Growth>;
+
+// Read-only version of a HashMap built by HashMap::freeze(), defined in FrozenHashMap.h
+template<typename K, typename T, typename Hash = DefaultHash<K>>
+class FrozenHashMap;
+
+//========================================================================================================================
+//                                                  HashMap
+//========================================================================================================================
+
+// The Storage template parameter selects the engine: ChainedTable (default, the original one), FlatTable (open addressing),
+// IncrementalTable, EpochTable (O(1) clear), DirectTable (integer keys) or BloomChainedTable / BloomFlatTable (a Bloom filter
+// in front, for lookups that mostly miss) and the Growth parameter the bucket policy:
+// PowerOfTwoGrowth (default) or PrimeGrowth (the original one)
+// Example: HashMap<int, long long, DefaultHash<int>, FlatTable> memo;
+template<typename K, typename T, typename Hash = DefaultHash<K>,
+         template<typename, typename, typename, typename> class Storage = ChainedTable, typename Growth = PowerOfTwoGrowth> 
+class HashMap {
+    private:
+        Storage<K, T, Hash, Growth> table; // All the memory layout is delegated to the storage engine
+#ifdef HASHMAP_STATS
+        mutable LookupCounters counters; // mutable because the lookups are const
+#endif
+
+        // Every lookup and insertion of the table goes through these two, they only count it for the statistics and give the
+        // result back. Without HASHMAP_STATS they are empty and the compiler removes them
+        template<typename Entry>
+        Entry* counted(Entry* entry) const {
+            HASHMAP_STAT(entry != nullptr ? counters.hits++ : counters.misses++);
+            return entry;
+        }
+
+        template<typename Result>
+        Result countedInsert(Result result) {
+            HASHMAP_STAT(result.second ? counters.inserts++ : counters.hits++);
+            return result;
+        }
+
+        static constexpr size_t kBatch = 16; // Keys whose cache misses overlap in the batched lookups, about the misses a core can have in flight
+
+        // Core of the batched lookups: calls use(i, entry of keys[i] or nullptr) for every key, in order
+        template<typename F>
+        void lookupMany(const K* keys, size_t count, F&& use) const {
+            Hash hasher;
+            unsigned long long hashes[kBatch];
+            for (size_t start = 0; start < count; start += kBatch) {
+                size_t n = std::min(kBatch, count - start);
+                for (size_t i = 0; i < n; i++) { // 1. Hash the whole block and ask for the buckets
+                    hashes[i] = hasher(keys[start + i]);
+                    table.prefetch(hashes[i]);
+                }
+                for (size_t i = 0; i < n; i++) { // 2. The buckets are arriving, ask for the first entries of the chains
+                    table.prefetchEntry(hashes[i]);
+                }
+                for (size_t i = 0; i < n; i++) { // 3. Compare the keys, most of the memory is already in the cache
+                    use(start + i, counted(table.findEntryHashed(keys[start + i], hashes[i])));
+                }
+            }
+        }
+
+    public:
+        HashMap() {} // UPDATE: An empty map does not allocate anything until the first insertion
+
+        HashMap(size_t initialSize) : table(initialSize) {} // Constructor with custom initial size (number of buckets, allocated now)
+
+        // UPDATE: Allocator support, all the memory of the map comes from resource instead of the heap (see Allocators.h).
+        // Example: Arena arena; HashMap<int, long long> memo(&arena); and the whole memo is freed with the arena.
+        // The resource must live longer than the map
+        explicit HashMap(std::pmr::memory_resource* resource) : table(resource) {}
+
+        HashMap(size_t initialSize, std::pmr::memory_resource* resource) : table(initialSize, resource) {}
+
+        // Here we insert or update the key-value pair
+        void set(const K& key, const T& value) {
+            insert_or_assign(key, value);
+        }
+
+        // UPDATE: Single probe API. Before, our callers did contains() and then get() (or set() and then get()), which hashed the key
+        // and walked the bucket two to four times. These methods do everything with only one lookup.
+
+        // Returns a pointer to the value of the key, or nullptr if it does not exist. Usage: if (auto* v = map.find(k)) use(*v);
+        // The pointer is valid until the next insertion (the FlatTable may move the slots when it resizes)
+        T* find(const K& key) {
+            HashEntry<K, T>* entry = counted(table.findEntry(key));
+            return entry == nullptr ? nullptr : &entry->second;
+        }
+
+        const T* find(const K& key) const {
+            const HashEntry<K, T>* entry = counted(table.findEntry(key));
+            return entry == nullptr ? nullptr : &entry->second;
+        }
+
+        // Inserts the key with a value built from args only if the key does not exist (if it exists nothing is built or changed).
+        // Returns the pointer to the value and true if it was inserted, like std::unordered_map::try_emplace
+        template<typename... Args>
+        std::pair<T*, bool> try_emplace(const K& key, Args&&... args) {
+            auto result = countedInsert(table.tryEmplace(key, std::forward<Args>(args)...));
+            return {&result.first->second, result.second};
+        }
+
+        template<typename... Args>
+        std::pair<T*, bool> try_emplace(K&& key, Args&&... args) { // Overload that moves the key into the table
+            auto result = countedInsert(table.tryEmplace(std::move(key), std::forward<Args>(args)...));
+            return {&result.first->second, result.second};
+        }
+
+        // Inserts the key or overwrites its value. Returns the pointer to the value and true if it was inserted
+        template<typename V>
+        std::pair<T*, bool> insert_or_assign(const K& key, V&& value) {
+            auto result = countedInsert(table.tryEmplace(key, std::forward<V>(value))); // The engines only use value when they insert,
+            if (!result.second) {                                                       // so here it has not been moved yet
+                result.first->second = std::forward<V>(value); // Updates existing value
+            }
+            return {&result.first->second, result.second};
+        }
+
+        template<typename V>
+        std::pair<T*, bool> insert_or_assign(K&& key, V&& value) {
+            auto result = countedInsert(table.tryEmplace(std::move(key), std::forward<V>(value)));
+            if (!result.second) {
+                result.first->second = std::forward<V>(value);
+            }
+            return {&result.first->second, result.second};
+        }
+
+        // Returns a reference to the value of the key, inserting a default constructed value if it does not exist
+        T& operator[](const K& key) {
+            return countedInsert(table.tryEmplace(key)).first->second;
+        }
+
+        T& operator[](K&& key) {
+            return countedInsert(table.tryEmplace(std::move(key))).first->second;
+        }
+
+        // Append for vector types only - enables only when T is a vector (Solution helped with AI as we strugled with the correct enable_if syntax)
+        template<typename ElementType>
+        typename std::enable_if<std::is_same<T, std::vector<ElementType>>::value, void>::type // This enables the function only if T is vector<ElementType>
+        append(const K& key, const ElementType& value) { // Strings are also supported as they are vectors of char
+            countedInsert(table.tryEmplace(key)).first->second.push_back(value); // If the key is new it starts with an empty vector
+        }
+
+        // We will add a size function to get the number of elements
+        size_t size() const {
+            return table.size();
+        }
+
+        // Now we add a fucntion for checking if a key exists
+        bool contains(const K& key) const {
+            return counted(table.findEntry(key)) != nullptr;
+        }
+
+        // Now we add a function to get the value for a key
+        T get(const K& key) const {
+            const HashEntry<K, T>* entry = counted(table.findEntry(key));
+            if (entry == nullptr) {
+                // In case the key does not exist, we throw an exception because we do not want to return a default value.
+                throw std::runtime_error("Key not found");
+            }
+            return entry->second;
+        }
+
+        // UPDATE We added a function to get a const reference to the value for a key to avoid copying large structures
+        const T& getRef(const K& key) const { // We made it const so the caller cannot modify the original value
+            const HashEntry<K, T>* entry = counted(table.findEntry(key));
+            if (entry == nullptr) {
+                throw std::runtime_error("Key not found");
+            }
+            return entry->second;
+        }
+
+        // UPDATE: In-place modification. Before, to change a value (like pushing to an adjacency list) we did get(), modified
+        // the copy and set() it back, which copies the whole value twice and makes building a list O(degree^2).
+
+        // Same as getRef but the value can be modified. Throws if the key does not exist
+        T& getMut(const K& key) {
+            HashEntry<K, T>* entry = counted(table.findEntry(key));
+            if (entry == nullptr) {
+                throw std::runtime_error("Key not found");
+            }
+            return entry->second;
+        }
+
+        // Calls fn(value) on the value of the key if it exists, returns false (and does nothing) if it does not
+        template<typename F>
+        bool update(const K& key, F&& fn) {
+            HashEntry<K, T>* entry = counted(table.findEntry(key));
+            if (entry == nullptr) return false;
+            fn(entry->second);
+            return true;
+        }
+
+        // Calls fn(value) on the value of the key, inserting a default constructed value first if the key does not exist (one
+        // single lookup). Returns a reference to the value. Example: graph.upsert(from, [&](auto& list) { list.push_back(to); });
+        template<typename F>
+        T& upsert(const K& key, F&& fn) {
+            T& value = countedInsert(table.tryEmplace(key)).first->second;
+            fn(value);
+            return value;
+        }
+
+        template<typename F>
+        T& upsert(K&& key, F&& fn) {
+            T& value = countedInsert(table.tryEmplace(std::move(key))).first->second;
+            fn(value);
+            return value;
+        }
+
+        // UPDATE: Heterogeneous lookup, only when the hash functor is transparent (DefaultHash<std::string> is). They take any
+        // type the hash accepts, for example map.contains(std::string_view(line).substr(0, 3)) or map.get("out"), without
+        // building a temporary K. When the argument is already a K the normal overloads above are chosen
+        template<typename Q, typename H = Hash, typename std::enable_if<IsTransparent<H>::value, int>::type = 0>
+        T* find(const Q& key) {
+            HashEntry<K, T>* entry = counted(table.findEntry(key));
+            return entry == nullptr ? nullptr : &entry->second;
+        }
+
+        template<typename Q, typename H = Hash, typename std::enable_if<IsTransparent<H>::value, int>::type = 0>
+        const T* find(const Q& key) const {
+            const HashEntry<K, T>* entry = counted(table.findEntry(key));
+            return entry == nullptr ? nullptr : &entry->second;
+        }
+
+        template<typename Q, typename H = Hash, typename std::enable_if<IsTransparent<H>::value, int>::type = 0>
+        bool contains(const Q& key) const {
+            return counted(table.findEntry(key)) != nullptr;
+        }
+
+        template<typename Q, typename H = Hash, typename std::enable_if<IsTransparent<H>::value, int>::type = 0>
+        T get(const Q& key) const {
+            return getRef(key);
+        }
+
+        template<typename Q, typename H = Hash, typename std::enable_if<IsTransparent<H>::value, int>::type = 0>
+        const T& getRef(const Q& key) const {
+            const HashEntry<K, T>* entry = counted(table.findEntry(key));
+            if (entry == nullptr) {
+                throw std::runtime_error("Key not found");
+            }
+            return entry->second;
+        }
+
+        // UPDATE: Batched lookups. When we have a lot of independent keys (a list of queries, a BFS frontier...) and the table
+        // does not fit in the cache, a loop of find() waits for the cache misses of one key before starting the next one.
+        // These methods hash a block of keys and prefetch all their buckets first, so the misses of the block overlap.
+        // The results are the same as calling find, get or contains for every key.
+
+        // out[i] is a pointer to the value of keys[i], or nullptr if it does not exist
+        void findMany(const K* keys, size_t count, const T** out) const {
+            lookupMany(keys, count, [&](size_t i, const HashEntry<K, T>* entry) {
+                out[i] = entry == nullptr ? nullptr : &entry->second;
+            });
+        }
+
+        void findMany(const K* keys, size_t count, T** out) {
+            lookupMany(keys, count, [&](size_t i, const HashEntry<K, T>* entry) {
+                out[i] = entry == nullptr ? nullptr : &const_cast<HashEntry<K, T>*>(entry)->second;
+            });
+        }
+
+        // out[i] is the value of keys[i]. Like get, it throws if a key does not exist
+        void getMany(const K* keys, size_t count, T* out) const {
+            lookupMany(keys, count, [&](size_t i, const HashEntry<K, T>* entry) {
+                if (entry == nullptr) {
+                    throw std::runtime_error("Key not found");
+                }
+                out[i] = entry->second;
+            });
+        }
+
+        std::vector<T> getMany(const std::vector<K>& keys) const {
+            std::vector<T> values(keys.size());
+            getMany(keys.data(), keys.size(), values.data());
+            return values;
+        }
+
+        // found[i] tells if keys[i] exists (found can be nullptr if we only need the count). Returns how many keys exist
+        size_t containsMany(const K* keys, size_t count, bool* found = nullptr) const {
+            size_t total = 0;
+            lookupMany(keys, count, [&](size_t i, const HashEntry<K, T>* entry) {
+                if (found != nullptr) found[i] = entry != nullptr;
+                total += entry != nullptr;
+            });
+            return total;
+        }
+
+        std::vector<bool> containsMany(const std::vector<K>& keys) const {
+            std::vector<bool> found(keys.size());
+            lookupMany(keys.data(), keys.size(), [&](size_t i, const HashEntry<K, T>* entry) {
+                found[i] = entry != nullptr;
+            });
+            return found;
+        }
+
+        void remove(const K& key) {
+            if (!table.erase(key)) {
+                throw std::runtime_error("Key not found for removal");
+            }
+            HASHMAP_STAT(counters.erases++);
+        }
+
+        // UPDATE: Calls f(key, value) for every pair of the map, in no particular order. The map must not be modified inside f
+        template<typename F>
+        void forEach(F&& f) const {
+            table.forEach([&](const HashEntry<K, T>& entry) { f(entry.first, entry.second); });
+        }
+
+        template<typename F>
+        void forEach(F&& f) { // Same but the values can be modified
+            table.forEach([&](HashEntry<K, T>& entry) { f(static_cast<const K&>(entry.first), entry.second); });
+        }
+
+        // UPDATE: Builds a read-only copy of the map with a minimal perfect hash, where a lookup is one hash and one slot read
+        // (see FrozenHashMap.h, it has to be included to call these). When the map is not needed anymore, std::move(map).freeze()
+        // moves the keys and values instead of copying them and leaves the map empty
+        FrozenHashMap<K, T, Hash> freeze() const & {
+            std::vector<HashEntry<K, T>> entries;
+            entries.reserve(size());
+            table.forEach([&](const HashEntry<K, T>& entry) { entries.push_back(entry); });
+            return FrozenHashMap<K, T, Hash>(std::move(entries));
+        }
+
+        FrozenHashMap<K, T, Hash> freeze() && {
+            std::vector<HashEntry<K, T>> entries;
+            entries.reserve(size());
+            table.forEach([&](HashEntry<K, T>& entry) { entries.push_back(std::move(entry)); });
+            table.clear();
+            return FrozenHashMap<K, T, Hash>(std::move(entries));
+        }
+
+        void clear() { // Function for clearing the hash map (it keeps the buckets, use shrink_to_fit to free them)
+            table.clear();
+        }
+
+        // UPDATE: Capacity management, if we know how many keys a map will hold we can allocate once instead of resizing on the way
+
+        // Number of buckets (slots for the FlatTable), 0 if the map has not allocated anything yet
+        size_t bucketCount() const {
+            return table.bucketCount();
+        }
+
+        // Makes room for n elements, so the next n insertions do not resize
+        void reserve(size_t n) {
+            table.reserve(n);
+        }
+
+        // Changes the number of buckets to at least 'buckets', but never less than the current elements need
+        void rehash(size_t buckets) {
+            table.rehash(buckets);
+        }
+
+        // Reduces the buckets to what the current elements need, an empty map frees all its memory
+        void shrink_to_fit() {
+            table.shrinkToFit();
+        }
+
+#ifdef HASHMAP_STATS
+        // UPDATE: Statistics, only when compiling with -DHASHMAP_STATS (see Statistics above). stats() walks the whole table,
+        // so it is O(buckets), it is made to be called at the end of a run and not inside a loop
+        HashMapStats stats() const {
+            HashMapStats result = table.stats();
+            result.lookups = counters;
+            return result;
+        }
+
+        // Example: std::cerr << memo.statsJson() << std::endl;
+        std::string statsJson() const {
+            return stats().toJson();
+        }
+
+        // Sets the hits, misses, inserts and erases to 0 (the rehashes and bytes belong to the table and are kept)
+        void resetStats() {
+            counters = LookupCounters();
+        }
+#endif
+};
+
+// DenseMap: a HashMap with the DirectTable engine, for small non-negative integer keys whose range is known or dense (grid
+// cells, node ids). Same API as the HashMap, reserve(n) gives a slot to every key in [0, n).
+// Example: DenseMap<int, long long> memo; memo.reserve(rows * cols);
+template<typename K, typename T>
+using DenseMap = HashMap<K, T, DefaultHash<K>, DirectTable>;
+
+#endif
@@ -0,0 +1,123 @@
+// HashSet: a set of keys on top of the same storage engines as our HashMap, but without any value.
+// Before, we used HashMap<K, bool> as a set (visited nodes of the BFS, columns already seen in AoC7), which stores a bool
+// (plus padding) for every key and needs two calls for "insert if it is not there". Here the value is an empty type that
+// takes no space (see HashEntry in HashMap.h) and insert() tells if the key was new with a single lookup.
+
+#ifndef HASHSET_H
+#define HASHSET_H
+
+#include "HashMap.h"
+
+// Empty value stored by the engines of the HashSet
+struct NoValue {};
+
+// Same template parameters as the HashMap without the value: HashSet<int>, HashSet<string, DefaultHash<string>, FlatTable>
+template<typename K, typename Hash = DefaultHash<K>,
+         template<typename, typename, typename, typename> class Storage = ChainedTable, typename Growth = PowerOfTwoGrowth>
+class HashSet {
+    private:
+        Storage<K, NoValue, Hash, Growth> table;
+#ifdef HASHMAP_STATS
+        mutable LookupCounters counters; // Same statistics as the HashMap (see Statistics in HashMap.h)
+#endif
+
+        bool countedInsert(bool inserted) {
+            HASHMAP_STAT(inserted ? counters.inserts++ : counters.hits++);
+            return inserted;
+        }
+
+        bool countedLookup(bool found) const {
+            HASHMAP_STAT(found ? counters.hits++ : counters.misses++);
+            return found;
+        }
+
+    public:
+        HashSet() {} // Like the HashMap, an empty set does not allocate anything
+
+        HashSet(size_t initialSize) : table(initialSize) {}
+
+        // Same allocator support as the HashMap (see Allocators.h), the resource must live longer than the set
+        explicit HashSet(std::pmr::memory_resource* resource) : table(resource) {}
+
+        HashSet(size_t initialSize, std::pmr::memory_resource* resource) : table(initialSize, resource) {}
+
+        // Inserts the key, returns true if it was not in the set (one lookup). Usage: if (visited.insert(node)) { first visit }
+        bool insert(const K& key) {
+            return countedInsert(table.tryEmplace(key).second);
+        }
+
+        bool insert(K&& key) {
+            return countedInsert(table.tryEmplace(std::move(key)).second);
+        }
+
+        bool contains(const K& key) const {
+            return countedLookup(table.findEntry(key) != nullptr);
+        }
+
+        // Heterogeneous version, only when the hash is transparent (e.g. a HashSet<string> searched with a string_view)
+        template<typename Q, typename H = Hash, typename std::enable_if<IsTransparent<H>::value, int>::type = 0>
+        bool contains(const Q& key) const {
+            return countedLookup(table.findEntry(key) != nullptr);
+        }
+
+        // Same behaviour as HashMap::remove, it throws if the key is not in the set
+        void remove(const K& key) {
+            if (!table.erase(key)) {
+                throw std::runtime_error("Key not found for removal");
+            }
+            HASHMAP_STAT(counters.erases++);
+        }
+
+        // Removes the key if it is in the set, returns true if it was removed
+        bool erase(const K& key) {
+            bool erased = table.erase(key);
+            HASHMAP_STAT(counters.erases += erased);
+            return erased;
+        }
+
+        size_t size() const {
+            return table.size();
+        }
+
+        bool empty() const {
+            return table.size() == 0;
+        }
+
+        void clear() { // Keeps the buckets, like HashMap::clear
+            table.clear();
+        }
+
+        size_t bucketCount() const {
+            return table.bucketCount();
+        }
+
+        void reserve(size_t n) {
+            table.reserve(n);
+        }
+
+        void rehash(size_t buckets) {
+            table.rehash(buckets);
+        }
+
+        void shrink_to_fit() {
+            table.shrinkToFit();
+        }
+
+#ifdef HASHMAP_STATS
+        HashMapStats stats() const {
+            HashMapStats result = table.stats();
+            result.lookups = counters;
+            return result;
+        }
+
+        std::string statsJson() const {
+            return stats().toJson();
+        }
+
+        void resetStats() {
+            counters = LookupCounters();
+        }
+#endif
+};
+
+#endif
@@ -0,0 +1,232 @@
+// SmallVector: a vector that keeps its first N elements inside the object itself and only goes to the heap when it grows
+// past them. Made for the adjacency lists of the Graph: most nodes of AoC11 have 1 to 4 neighbors, and with std::vector every
+// node had its own heap block (one allocation when it is built and one more cache miss every time its neighbors are read).
+// With a SmallVector the neighbors are stored in the map entry, next to the key.
+// It has the part of the std::vector interface that we use (push_back, emplace_back, erase, iterators, operator[]...), the
+// iterators are plain pointers. Like a std::vector, any insertion can invalidate the pointers and iterators.
+
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <cstddef>
+#include <memory> // std::allocator, std::uninitialized_copy / move, std::destroy
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+
+template<typename T, size_t N>
+class SmallVector {
+    static_assert(N > 0, "SmallVector needs at least one inline element, use std::vector otherwise");
+
+    private:
+        T* items; // The inline buffer while the elements fit in it, a heap block after
+        size_t count;
+        size_t cap;
+        alignas(T) unsigned char buffer[N * sizeof(T)]; // Raw memory, the elements are only constructed when they are added
+
+        T* inlineData() {
+            return reinterpret_cast<T*>(buffer);
+        }
+
+        // Moves the elements to a heap block of newCap elements (newCap > count)
+        void moveTo(size_t newCap) {
+            T* block = std::allocator<T>().allocate(newCap);
+            std::uninitialized_move(items, items + count, block);
+            release();
+            items = block;
+            cap = newCap;
+        }
+
+        // Destroys the elements and frees the heap block if there is one (the object must be reset or reused after it)
+        void release() {
+            std::destroy(items, items + count);
+            if (!isInline()) std::allocator<T>().deallocate(items, cap);
+        }
+
+        // Takes the elements of other, which is left empty. This object must not own anything
+        void takeFrom(SmallVector&& other) {
+            if (other.isInline()) { // The inline elements can not be stolen, they are moved one by one
+                items = inlineData();
+                cap = N;
+                std::uninitialized_move(other.items, other.items + other.count, items);
+                count = other.count;
+                other.clear();
+            } else { // A heap block is just stolen
+                items = other.items;
+                count = other.count;
+                cap = other.cap;
+                other.items = other.inlineData();
+                other.count = 0;
+                other.cap = N;
+            }
+        }
+
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        SmallVector() : items(inlineData()), count(0), cap(N) {}
+
+        template<typename InputIt>
+        SmallVector(InputIt first, InputIt last) : SmallVector() {
+            for (; first != last; ++first) emplace_back(*first);
+        }
+
+        SmallVector(std::initializer_list<T> values) : SmallVector(values.begin(), values.end()) {}
+
+        SmallVector(const SmallVector& other) : SmallVector() {
+            reserve(other.count);
+            std::uninitialized_copy(other.begin(), other.end(), items);
+            count = other.count;
+        }
+
+        SmallVector(SmallVector&& other) noexcept {
+            takeFrom(std::move(other));
+        }
+
+        SmallVector& operator=(const SmallVector& other) {
+            if (this != &other) {
+                clear();
+                reserve(other.count);
+                std::uninitialized_copy(other.begin(), other.end(), items);
+                count = other.count;
+            }
+            return *this;
+        }
+
+        SmallVector& operator=(SmallVector&& other) noexcept {
+            if (this != &other) {
+                release();
+                takeFrom(std::move(other));
+            }
+            return *this;
+        }
+
+        ~SmallVector() {
+            release();
+        }
+
+        // Adds an element at the end. When the storage is full the new element is built in the new block before the old ones
+        // are moved, so emplace_back(v[0]) is safe
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            if (count == cap) {
+                size_t newCap = cap * 2;
+                T* block = std::allocator<T>().allocate(newCap);
+                ::new (static_cast<void*>(block + count)) T(std::forward<Args>(args)...);
+                std::uninitialized_move(items, items + count, block);
+                release();
+                items = block;
+                cap = newCap;
+            } else {
+                ::new (static_cast<void*>(items + count)) T(std::forward<Args>(args)...);
+            }
+            return items[count++];
+        }
+
+        void push_back(const T& value) {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value) {
+            emplace_back(std::move(value));
+        }
+
+        void pop_back() {
+            items[--count].~T();
+        }
+
+        // Removes [first, last) moving the following elements back, returns the position after the removed ones
+        iterator erase(const_iterator first, const_iterator last) {
+            T* from = items + (first - items);
+            T* to = items + (last - items);
+            if (from != to) {
+                T* newEnd = std::move(to, end(), from);
+                std::destroy(newEnd, end());
+                count = newEnd - items;
+            }
+            return from;
+        }
+
+        iterator erase(const_iterator position) {
+            return erase(position, position + 1);
+        }
+
+        // Destroys the elements, the heap block (if any) is kept like in std::vector
+        void clear() {
+            std::destroy(items, items + count);
+            count = 0;
+        }
+
+        void reserve(size_t n) {
+            if (n > cap) moveTo(n);
+        }
+
+        // Goes back to the inline buffer if the elements fit in it, or to a heap block of the exact size
+        void shrink_to_fit() {
+            if (isInline() || count == cap) return;
+            if (count <= N) {
+                T* block = items;
+                size_t blockCap = cap;
+                items = inlineData();
+                cap = N;
+                std::uninitialized_move(block, block + count, items);
+                std::destroy(block, block + count);
+                std::allocator<T>().deallocate(block, blockCap);
+            } else {
+                moveTo(count);
+            }
+        }
+
+        // True while the elements are stored in the object (no heap block)
+        bool isInline() const {
+            return items == reinterpret_cast<const T*>(buffer);
+        }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        size_t capacity() const { return cap; }
+        static constexpr size_t inlineCapacity() { return N; }
+
+        T* data() { return items; }
+        const T* data() const { return items; }
+        iterator begin() { return items; }
+        iterator end() { return items + count; }
+        const_iterator begin() const { return items; }
+        const_iterator end() const { return items + count; }
+        const_iterator cbegin() const { return items; }
+        const_iterator cend() const { return items + count; }
+
+        T& operator[](size_t i) { return items[i]; }
+        const T& operator[](size_t i) const { return items[i]; }
+        T& front() { return items[0]; }
+        const T& front() const { return items[0]; }
+        T& back() { return items[count - 1]; }
+        const T& back() const { return items[count - 1]; }
+
+        T& at(size_t i) {
+            if (i >= count) throw std::out_of_range("SmallVector index out of range");
+            return items[i];
+        }
+
+        const T& at(size_t i) const {
+            if (i >= count) throw std::out_of_range("SmallVector index out of range");
+            return items[i];
+        }
+
+        bool operator==(const SmallVector& other) const {
+            return count == other.count && std::equal(begin(), end(), other.begin());
+        }
+
+        bool operator!=(const SmallVector& other) const {
+            return !(*this == other);
+        }
+};
+
+#endif
@@ -0,0 +1,353 @@
+// Snapshot: writes a HashMap to a file that can be opened again with mmap and used right away, without reading it into
+// memory or rebuilding anything (no deserialization). Useful for memo tables that take a long time to compute and are the
+// same between runs: the first run computes the memo and writes it, the next ones map the file and start answering.
+// The file keeps a PerfectHashIndex (see FrozenHashMap.h) and the pairs in the positions it gives, so a lookup in the mapped
+// file is the same as in a FrozenHashMap: one hash, one read of the pilot and one read of the slot.
+// Keys and values must be trivially copyable (they are written as bytes), except the keys of type std::string, which are
+// written in a separate block of characters that the slots point to with an offset and a length.
+// The file is only valid on a machine with the same endianness and the same layout of K and T, the header checks it.
+// Only for Linux (POSIX open and mmap).
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "FrozenHashMap.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <cstdio> // std::rename
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//========================================================================================================================
+//                                                  File format
+//========================================================================================================================
+// header | pilots (uint16 per bucket) | remap (uint32) | slots (one per key, in position order) | characters of the string keys
+// Every block starts at a multiple of 64 bytes, so the slots are aligned however the values are.
+// UPDATE: Keys with the same full hash share a position of the index (see PerfectHashIndex), so the first one gets the slot
+// of the position and the others are written after the params.keys slots of the positions (overflowSlots of the header).
+
+constexpr char kSnapshotMagic[8] = "AOCSNAP";
+constexpr uint32_t kSnapshotVersion = 2; // Increase it when the format changes, the old files are then rejected
+                                         // 2: overflowSlots for keys with the same hash
+constexpr uint32_t kSnapshotEndianCheck = 0x01020304; // Read back in the wrong order on a machine with the other endianness
+constexpr uint64_t kSnapshotAlignment = 64;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianCheck;
+    uint32_t keyKind; // 0: the key is in the slot, 1: std::string key in the block of characters
+    uint32_t keySize; // sizeof(K) (0 for strings)
+    uint32_t valueSize; // sizeof(T)
+    uint32_t slotSize; // sizeof of the slot, it also changes if the alignment of K or T changes
+    PerfectHashIndex::Params params;
+    uint64_t pilotsOffset;
+    uint64_t remapOffset;
+    uint64_t slotsOffset;
+    uint64_t overflowSlots; // Slots after the params.keys of the positions, for keys with the hash of another key
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t fileSize;
+    uint64_t hashCheck; // Hash of the key of the first slot, to notice a file written with another hash function
+};
+
+// What a slot of the file looks like for each kind of key
+template<typename K, typename T>
+struct SnapshotSlot {
+    static constexpr uint32_t kKeyKind = 0;
+    K key;
+    T value;
+};
+
+template<typename T>
+struct SnapshotSlot<std::string, T> {
+    static constexpr uint32_t kKeyKind = 1;
+    uint64_t hash; // Full hash of the key, a miss almost never compares the characters (like the HashCache of the HashMap)
+    uint64_t offset; // Characters of the key in the block of strings
+    uint64_t length;
+    T value;
+};
+
+inline uint64_t snapshotAlign(uint64_t offset) {
+    return (offset + kSnapshotAlignment - 1) / kSnapshotAlignment * kSnapshotAlignment;
+}
+
+//========================================================================================================================
+//                                                  writeSnapshot
+//========================================================================================================================
+// Writes the map to path. It first writes path + ".tmp" and then renames it, so a run that dies in the middle never leaves a
+// broken file with the final name. Throws if the file can not be written
+template<typename K, typename T, typename Hash, template<typename, typename, typename, typename> class Storage, typename Growth>
+void writeSnapshot(const HashMap<K, T, Hash, Storage, Growth>& map, const std::string& path) {
+    using Slot = SnapshotSlot<K, T>;
+    constexpr bool stringKey = std::is_same<K, std::string>::value;
+    static_assert(stringKey || std::is_trivially_copyable<K>::value, "writeSnapshot: the key must be trivially copyable or std::string");
+    static_assert(std::is_trivially_copyable<T>::value, "writeSnapshot: the value must be trivially copyable");
+    static_assert(alignof(Slot) <= kSnapshotAlignment, "writeSnapshot: the slot needs more alignment than the blocks of the file");
+
+    Hash hasher;
+    std::vector<const K*> keys;
+    std::vector<const T*> values;
+    std::vector<unsigned long long> hashes;
+    keys.reserve(map.size());
+    values.reserve(map.size());
+    hashes.reserve(map.size());
+    map.forEach([&](const K& key, const T& value) {
+        keys.push_back(&key);
+        values.push_back(&value);
+        hashes.push_back(hasher(key));
+    });
+    PerfectHashIndex index(hashes);
+
+    // Value-initialized, so the padding of the slots is written as zeros and two snapshots of the same map are equal. The
+    // first index.size() slots are the positions, the overflow slots are added after them
+    std::vector<Slot> slots(index.size());
+    std::vector<bool> used(index.size(), false);
+    std::string strings;
+    unsigned long long firstHash = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+        size_t position = index.position(hashes[i]);
+        if (used[position]) {
+            position = slots.size();
+            slots.emplace_back();
+        } else {
+            used[position] = true;
+        }
+        if (position == 0) firstHash = hashes[i];
+        Slot& slot = slots[position];
+        if constexpr (stringKey) {
+            slot.hash = hashes[i];
+            slot.offset = strings.size();
+            slot.length = keys[i]->size();
+            strings += *keys[i];
+        } else {
+            slot.key = *keys[i];
+        }
+        slot.value = *values[i];
+    }
+
+    SnapshotHeader header{}; // All zeros (it has no padding)
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.endianCheck = kSnapshotEndianCheck;
+    header.keyKind = Slot::kKeyKind;
+    header.keySize = stringKey ? 0 : sizeof(K);
+    header.valueSize = sizeof(T);
+    header.slotSize = sizeof(Slot);
+    header.params = index.getParams();
+    header.pilotsOffset = snapshotAlign(sizeof(SnapshotHeader));
+    header.remapOffset = snapshotAlign(header.pilotsOffset + index.getPilots().size() * sizeof(uint16_t));
+    header.slotsOffset = snapshotAlign(header.remapOffset + index.getRemap().size() * sizeof(uint32_t));
+    header.overflowSlots = slots.size() - index.size();
+    header.stringsOffset = snapshotAlign(header.slotsOffset + slots.size() * sizeof(Slot));
+    header.stringsSize = strings.size();
+    header.fileSize = header.stringsOffset + strings.size();
+    header.hashCheck = firstHash;
+
+    std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    uint64_t written = 0;
+    // Writes a block at its offset, with zeros before it up to the offset
+    auto writeBlock = [&](uint64_t offset, const void* data, uint64_t bytes) {
+        static const char zeros[kSnapshotAlignment] = {};
+        file.write(zeros, static_cast<std::streamsize>(offset - written));
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        written = offset + bytes;
+    };
+    writeBlock(0, &header, sizeof(header));
+    writeBlock(header.pilotsOffset, index.getPilots().data(), index.getPilots().size() * sizeof(uint16_t));
+    writeBlock(header.remapOffset, index.getRemap().data(), index.getRemap().size() * sizeof(uint32_t));
+    writeBlock(header.slotsOffset, slots.data(), slots.size() * sizeof(Slot));
+    writeBlock(header.stringsOffset, strings.data(), strings.size());
+    file.close();
+    if (!file || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("writeSnapshot: could not write " + path);
+    }
+}
+
+//========================================================================================================================
+//                                                  MappedHashMap
+//========================================================================================================================
+// Read-only map over a snapshot file. The constructor maps the file and checks its header, nothing else: the pages are read
+// by the kernel the first time a lookup touches them (and are shared with every other process that maps the same file).
+// Hash must be the same hash function that wrote the file. For std::string keys the lookups take a std::string_view and
+// forEach gives the keys as std::string_view, they point into the file.
+template<typename K, typename T, typename Hash = DefaultHash<K>>
+class MappedHashMap {
+    private:
+        using Slot = SnapshotSlot<K, T>;
+        static constexpr bool kStringKey = std::is_same<K, std::string>::value;
+        using Key = typename std::conditional<kStringKey, std::string_view, K>::type;
+
+        const char* data = nullptr; // The whole mapped file
+        size_t fileSize = 0;
+        PerfectHashIndex::Params params;
+        uint64_t overflowSlots = 0; // They come after the params.keys slots of the positions
+        const uint16_t* pilots = nullptr;
+        const uint32_t* remap = nullptr;
+        const Slot* slots = nullptr;
+        const char* strings = nullptr;
+        Hash hasher;
+
+        Key keyOf(const Slot& slot) const {
+            if constexpr (kStringKey) {
+                return std::string_view(strings + slot.offset, slot.length);
+            } else {
+                return slot.key;
+            }
+        }
+
+        bool matches(const Slot& slot, const Key& key, unsigned long long hash) const {
+            if constexpr (kStringKey) {
+                return slot.hash == hash && keyOf(slot) == key;
+            } else {
+                return slot.key == key;
+            }
+        }
+
+        void unmap() {
+            if (data != nullptr) munmap(const_cast<char*>(data), fileSize);
+            data = nullptr;
+            fileSize = 0;
+        }
+
+        // Throws after unmapping the file, the constructor did not finish so the destructor will not run
+        [[noreturn]] void fail(const std::string& path, const std::string& reason) {
+            unmap();
+            throw std::runtime_error("MappedHashMap: " + path + ": " + reason);
+        }
+
+    public:
+        explicit MappedHashMap(const std::string& path) {
+            static_assert(std::is_trivially_copyable<T>::value, "MappedHashMap: the value must be trivially copyable");
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("MappedHashMap: could not open " + path);
+            struct stat info;
+            if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+                close(fd);
+                throw std::runtime_error("MappedHashMap: " + path + " is not a snapshot");
+            }
+            fileSize = static_cast<size_t>(info.st_size);
+            void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd); // The mapping keeps the file open
+            if (mapped == MAP_FAILED) throw std::runtime_error("MappedHashMap: could not map " + path);
+            data = static_cast<const char*>(mapped);
+
+            SnapshotHeader header;
+            std::memcpy(&header, data, sizeof(header));
+            if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0) fail(path, "not a snapshot");
+            if (header.endianCheck != kSnapshotEndianCheck) fail(path, "written on a machine with another endianness");
+            if (header.version != kSnapshotVersion) fail(path, "version " + std::to_string(header.version) + ", expected "
+                                                               + std::to_string(kSnapshotVersion));
+            if (header.keyKind != Slot::kKeyKind || header.keySize != (kStringKey ? 0 : sizeof(K))
+                || header.valueSize != sizeof(T) || header.slotSize != sizeof(Slot)) {
+                fail(path, "written with other key or value types");
+            }
+            params = header.params;
+            overflowSlots = header.overflowSlots;
+            uint64_t remapSize = params.tableSize - params.keys;
+            if (header.fileSize != fileSize || params.tableSize < params.keys
+                || header.pilotsOffset + params.buckets * sizeof(uint16_t) > header.remapOffset
+                || header.remapOffset + remapSize * sizeof(uint32_t) > header.slotsOffset
+                || header.slotsOffset + (params.keys + overflowSlots) * sizeof(Slot) > header.stringsOffset
+                || header.stringsOffset + header.stringsSize > fileSize) {
+                fail(path, "truncated or corrupted");
+            }
+            pilots = reinterpret_cast<const uint16_t*>(data + header.pilotsOffset);
+            remap = reinterpret_cast<const uint32_t*>(data + header.remapOffset);
+            slots = reinterpret_cast<const Slot*>(data + header.slotsOffset);
+            strings = data + header.stringsOffset;
+
+            // A different hash function would give other positions and every lookup would miss without saying anything, so we
+            // hash the key of the first slot again and compare it with the hash the writer got
+            if (params.keys > 0 && hasher(keyOf(slots[0])) != header.hashCheck) {
+                fail(path, "written with another hash function");
+            }
+        }
+
+        MappedHashMap(const MappedHashMap&) = delete;
+        MappedHashMap& operator=(const MappedHashMap&) = delete;
+
+        MappedHashMap(MappedHashMap&& other) noexcept {
+            *this = std::move(other);
+        }
+
+        MappedHashMap& operator=(MappedHashMap&& other) noexcept {
+            if (this != &other) {
+                unmap();
+                data = std::exchange(other.data, nullptr);
+                fileSize = std::exchange(other.fileSize, 0);
+                params = other.params;
+                overflowSlots = other.overflowSlots;
+                pilots = other.pilots;
+                remap = other.remap;
+                slots = other.slots;
+                strings = other.strings;
+            }
+            return *this;
+        }
+
+        ~MappedHashMap() {
+            unmap();
+        }
+
+        // Returns a pointer to the value of the key (inside the mapped file), or nullptr if it is not in the map
+        const T* find(const Key& key) const {
+            if (params.keys == 0) return nullptr;
+            unsigned long long hash = hasher(key);
+            const Slot& slot = slots[PerfectHashIndex::position(params, pilots, remap, hash)];
+            if (matches(slot, key, hash)) return &slot.value;
+            // Almost always zero: only keys that have the hash of another key are there
+            for (size_t i = params.keys; i < params.keys + overflowSlots; i++) {
+                if (matches(slots[i], key, hash)) return &slots[i].value;
+            }
+            return nullptr;
+        }
+
+        bool contains(const Key& key) const {
+            return find(key) != nullptr;
+        }
+
+        T get(const Key& key) const {
+            return getRef(key);
+        }
+
+        const T& getRef(const Key& key) const {
+            const T* value = find(key);
+            if (value == nullptr) {
+                throw std::runtime_error("Key not found");
+            }
+            return *value;
+        }
+
+        size_t size() const {
+            return static_cast<size_t>(params.keys + overflowSlots);
+        }
+
+        bool empty() const {
+            return params.keys == 0;
+        }
+
+        // Calls f(key, value) for every pair, in the order of the file
+        template<typename F>
+        void forEach(F&& f) const {
+            for (size_t i = 0; i < params.keys + overflowSlots; i++) f(keyOf(slots[i]), slots[i].value);
+        }
+
+        // Size of the file, the memory it uses once all its pages have been touched
+        size_t fileBytes() const {
+            return fileSize;
+        }
+};
+
+#endif